@@ -0,0 +1,49 @@
+#include "alloc_stats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// 计数只需要最终一致，用 relaxed 避免多线程下的额外开销
+static std::atomic<uint64_t> g_allocs{0};
+static std::atomic<uint64_t> g_frees{0};
+static std::atomic<uint64_t> g_bytes{0};
+
+AllocStats allocStats() {
+    AllocStats s;
+    s.allocs = g_allocs.load(std::memory_order_relaxed);
+    s.frees = g_frees.load(std::memory_order_relaxed);
+    s.bytes = g_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+static void *countedAlloc(std::size_t size) noexcept {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void countedFree(void *p) noexcept {
+    if (!p) return;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+}
+
+// 替换全局 operator new/delete（未覆盖 C++17 的对齐版本，项目中没有超对齐类型）
+void *operator new(std::size_t size) {
+    void *p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](std::size_t size) {
+    void *p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete[](void *p) noexcept { countedFree(p); }
+void operator delete(void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { countedFree(p); }
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * 全局堆分配计数
+ * alloc_stats.cpp 替换了全局 operator new/delete，每次分配和释放都会计数（原子操作，线程安全）
+ * 用法：在一段代码前后各取一次快照，相减即为这段代码的堆分配次数
+ */
+struct AllocStats {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0; // 累计申请的字节数
+
+    AllocStats operator-(const AllocStats &o) const {
+        return {allocs - o.allocs, frees - o.frees, bytes - o.bytes};
+    }
+};
+
+/**
+ * 当前的累计计数快照
+ */
+AllocStats allocStats();
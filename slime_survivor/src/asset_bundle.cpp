@@ -0,0 +1,157 @@
+#include "asset_bundle.h"
+#include <climits>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * 图片条目的宽、高、行距（param[0..2]）都要在 1..INT_MAX 之内（之后按 int 交给 SDL），
+ * 每行放得下 width 个 RGBA 像素，且所有行都在条目数据之内；乘法在 64 位下做，不会回绕
+ */
+static bool validImage(const BundleEntry &e) {
+    for (int i = 0; i < 3; ++i) {
+        if (e.param[i] == 0 || e.param[i] > (Uint32)INT_MAX) return false;
+    }
+    return (Uint64)e.param[0] * 4 <= e.param[2] && (Uint64)e.param[2] * e.param[1] <= e.size;
+}
+
+AssetBundle &AssetBundle::getInstance() {
+    static AssetBundle instance;
+    return instance;
+}
+
+AssetBundle::~AssetBundle() {
+    close();
+}
+
+bool AssetBundle::open(const string &path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SDL_Log("未找到资源包 %s，按散文件加载", path.c_str());
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    CloseHandle(file);
+    if (!mapping) {
+        SDL_Log("资源包 %s 映射失败", path.c_str());
+        return false;
+    }
+    base_ = (const Uint8 *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base_) {
+        CloseHandle(mapping);
+        SDL_Log("资源包 %s 映射失败", path.c_str());
+        return false;
+    }
+    mapping_ = mapping;
+    size_ = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        SDL_Log("未找到资源包 %s，按散文件加载", path.c_str());
+        return false;
+    }
+    struct stat st;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd); // 映射建立后文件描述符就不再需要
+    if (mapped == MAP_FAILED) {
+        SDL_Log("资源包 %s 映射失败", path.c_str());
+        return false;
+    }
+    base_ = (const Uint8 *)mapped;
+    size_ = (size_t)st.st_size;
+#endif
+
+    // 校验头部和每个条目的范围，之后的查询就不必再检查越界
+    BundleHeader header;
+    bool valid = size_ >= sizeof(header);
+    if (valid) {
+        memcpy(&header, base_, sizeof(header));
+        valid = memcmp(header.magic, BUNDLE_MAGIC, sizeof(header.magic)) == 0 && header.version == BUNDLE_VERSION;
+    }
+    const Uint64 namesStart = sizeof(header) + (Uint64)(valid ? header.count : 0) * sizeof(BundleEntry);
+    valid = valid && namesStart + header.namesSize <= size_;
+    if (valid) {
+        const BundleEntry *entries = (const BundleEntry *)(base_ + sizeof(header));
+        const char *names = (const char *)(base_ + namesStart);
+        index_.reserve(header.count);
+        for (Uint32 i = 0; i < header.count && valid; ++i) {
+            const BundleEntry &e = entries[i];
+            valid = (Uint64)e.nameOffset + e.nameLength <= header.namesSize && e.offset <= size_ && e.size <= size_ - e.offset;
+            if (valid && e.kind == BUNDLE_IMAGE) {
+                valid = validImage(e);
+            }
+            if (valid) index_[string(names + e.nameOffset, e.nameLength)] = &e;
+        }
+    }
+    if (!valid) {
+        SDL_Log("资源包 %s 格式错误或版本不匹配", path.c_str());
+        close();
+        return false;
+    }
+    SDL_Log("已映射资源包 %s：%d 项，%.1f MB", path.c_str(), (int)index_.size(), size_ / (1024.0 * 1024.0));
+    return true;
+}
+
+void AssetBundle::close() {
+    index_.clear();
+    if (!base_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle((HANDLE)mapping_);
+    mapping_ = nullptr;
+#else
+    munmap((void *)base_, size_);
+#endif
+    base_ = nullptr;
+    size_ = 0;
+}
+
+const BundleEntry *AssetBundle::find(const string &path, Uint32 kind) const {
+    auto it = index_.find(path);
+    if (it == index_.end() || it->second->kind != kind) return nullptr;
+    return it->second;
+}
+
+bool AssetBundle::image(const string &path, BundleImage &out) const {
+    const BundleEntry *e = find(path, BUNDLE_IMAGE);
+    if (!e) return false;
+    out = {base_ + e->offset, (int)e->param[0], (int)e->param[1], (int)e->param[2]};
+    return true;
+}
+
+bool AssetBundle::pcm(const string &path, BundlePcm &out) const {
+    const BundleEntry *e = find(path, BUNDLE_PCM);
+    if (!e) return false;
+    out = {base_ + e->offset, (Uint32)e->size, (int)e->param[0], (Uint16)e->param[1], (int)e->param[2]};
+    return true;
+}
+
+bool AssetBundle::raw(const string &path, const Uint8 *&data, size_t &size) const {
+    const BundleEntry *e = find(path, BUNDLE_RAW);
+    if (!e) return false;
+    data = base_ + e->offset;
+    size = (size_t)e->size;
+    return true;
+}
+
+SDL_RWops *AssetBundle::openRW(const string &path) const {
+    const Uint8 *data;
+    size_t size;
+    if (!raw(path, data, size)) return nullptr;
+    return SDL_RWFromConstMem(data, (int)size);
+}
@@ -1,8 +1,10 @@
 #include "audio_manager.h"
+#include "asset_bundle.h"
+#include <algorithm>
 #include <bitset>
 using namespace std;
 
-const char *AudioManager::BGM_FILES[6] = {
+const char *AudioManager::BGM_FILES[BGM_NUM] = {
     "../aud/bgm_menu.mp3",
     "../aud/bgm_action_1.mp3",
     "../aud/bgm_action_2.mp3",
@@ -10,6 +12,11 @@ const char *AudioManager::BGM_FILES[6] = {
     "../aud/bgm_action_4.mp3",
     "../aud/bgm_action_5.mp3"
 };
+const char *AudioManager::SFX_FILES[SFX_NUM] = {
+    "../aud/hurt.wav",
+};
+// 每首曲目之后最可能播放的曲目：菜单之后是开始游戏的战斗曲，战斗曲依次轮换
+const int AudioManager::NEXT_BGM[BGM_NUM] = {BGM_BATTLE, 2, 3, 4, 5, 1};
 
 AudioManager& AudioManager::getInstance() {
     static AudioManager instance;
@@ -26,40 +33,287 @@ bool AudioManager::init() {
         SDL_Log("Mix_OpenAudio failed: %s", Mix_GetError());
         return false;
     }
-    Mix_AllocateChannels(32);
-    return loadAudioAssets();
+    Mix_AllocateChannels(MIX_CHANNELS);
+    opened_ = loadAudioAssets();
+    if (!opened_) return false;
+    // 启动时马上要播菜单曲，这一首同步打开；之后的曲目都在预取线程打开
+    if (Mix_Music *menu = openMusic(BGM_MENU)) insertOpen(BGM_MENU, menu);
+    return true;
+}
+
+void AudioManager::quit() {
+    if (prefetchThread_.joinable()) {
+        {
+            lock_guard<mutex> lock(prefetchMutex_);
+            stopping_ = true;
+        }
+        prefetchCv_.notify_all();
+        prefetchThread_.join();
+    }
+    if (!opened_) return;
+    Mix_HaltMusic();
+    for (auto &bgm : open_) Mix_FreeMusic(bgm.music);
+    for (auto &bgm : prefetched_) {
+        if (bgm.music) Mix_FreeMusic(bgm.music);
+    }
+    open_.clear();
+    prefetched_.clear();
+    playing_ = pending_ = -1;
+    Mix_HaltChannel(-1);
+    for (auto &v : voices_) v = Voice();
+    for (auto &req : sfxRequests_) req = SfxRequest();
+    for (auto &chunk : sfx_) {
+        if (chunk) Mix_FreeChunk(chunk);
+        chunk = nullptr;
+    }
+    Mix_CloseAudio();
+    Mix_Quit();
+    opened_ = false;
+}
+
+/**
+ * 资源包里的 PCM 与设备格式一致时直接引用映射区（Mix_QuickLoad_RAW 不拷贝），否则返回 nullptr
+ */
+static Mix_Chunk *loadChunkFromBundle(const char *path) {
+    BundlePcm pcm;
+    if (!AssetBundle::getInstance().pcm(path, pcm)) return nullptr;
+    int freq = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&freq, &format, &channels);
+    if (pcm.freq != freq || pcm.format != format || pcm.channels != channels) {
+        SDL_Log("资源包中 %s 的采样格式与音频设备不一致，改为从文件加载", path);
+        return nullptr;
+    }
+    return Mix_QuickLoad_RAW(const_cast<Uint8 *>(pcm.data), pcm.size);
 }
 
 bool AudioManager::loadAudioAssets() {
-    for (int i = 0; i < 6; ++i) {
-        bgms_[i] = Mix_LoadMUS(BGM_FILES[i]);
-        if (bgms_[i] == nullptr) {
-            SDL_Log("Mix_LoadMUS failed: %s", Mix_GetError());
+    for (int i = 0; i < SFX_NUM; ++i) {
+        sfx_[i] = loadChunkFromBundle(SFX_FILES[i]);
+        if (!sfx_[i]) sfx_[i] = Mix_LoadWAV(SFX_FILES[i]);
+        if (sfx_[i] == nullptr) {
+            SDL_Log("Mix_LoadWAV failed: %s", Mix_GetError());
             return false;
         }
     }
-    hurt_ = Mix_LoadWAV("../aud/hurt.wav");
-    if (hurt_ == nullptr) {
-        SDL_Log("Mix_LoadWAV failed: %s", Mix_GetError());
-        return false;
-    }
     return true;
 }
 
+Mix_Music *AudioManager::openMusic(int idx) {
+    // 音乐在包中原样存放，播放时从映射区流式解码
+    SDL_RWops *rw = AssetBundle::getInstance().openRW(BGM_FILES[idx]);
+    Mix_Music *music = rw ? Mix_LoadMUS_RW(rw, 1) : Mix_LoadMUS(BGM_FILES[idx]);
+    if (music == nullptr) {
+        SDL_Log("Mix_LoadMUS failed: %s", Mix_GetError());
+    }
+    return music;
+}
+
+Mix_Music *AudioManager::findOpen(int idx) {
+    for (auto &bgm : open_) {
+        if (bgm.idx == idx) {
+            bgm.lastUsed = ++useClock_;
+            return bgm.music;
+        }
+    }
+    return nullptr;
+}
+
+void AudioManager::insertOpen(int idx, Mix_Music *music) {
+    open_.push_back({idx, music, ++useClock_});
+    evict();
+}
+
+void AudioManager::evict() {
+    while ((int)open_.size() > MAX_OPEN_BGM) {
+        // 淘汰最久没用过的曲目，正在播放和等待播放的除外
+        int victim = -1;
+        for (int i = 0; i < (int)open_.size(); ++i) {
+            if (open_[i].idx == playing_ || open_[i].idx == pending_) continue;
+            if (victim < 0 || open_[i].lastUsed < open_[victim].lastUsed) victim = i;
+        }
+        if (victim < 0) return;
+        Mix_FreeMusic(open_[victim].music);
+        open_.erase(open_.begin() + victim);
+    }
+}
+
+void AudioManager::collectPrefetched() {
+    vector<OpenBgm> ready;
+    {
+        lock_guard<mutex> lock(prefetchMutex_);
+        ready.swap(prefetched_);
+    }
+    for (auto &bgm : ready) {
+        if (!bgm.music) {
+            if (bgm.idx == pending_) pending_ = -1; // 打开失败，放弃这次播放
+            continue;
+        }
+        bool duplicate = false;
+        for (auto &open : open_) duplicate |= open.idx == bgm.idx;
+        if (duplicate) {
+            Mix_FreeMusic(bgm.music);
+        } else {
+            insertOpen(bgm.idx, bgm.music);
+        }
+    }
+}
+
+void AudioManager::prefetchBGM(int idx) {
+    if (!opened_ || idx < 0 || idx >= BGM_NUM) return;
+    queuePrefetch(idx, false);
+}
+
+void AudioManager::queuePrefetch(int idx, bool urgent) {
+    for (auto &bgm : open_) {
+        if (bgm.idx == idx) return;
+    }
+    {
+        lock_guard<mutex> lock(prefetchMutex_);
+        if (prefetching_ == idx) return;
+        for (auto &bgm : prefetched_) {
+            if (bgm.idx == idx) return;
+        }
+        auto queued = find(prefetchQueue_.begin(), prefetchQueue_.end(), idx);
+        if (queued != prefetchQueue_.end()) {
+            if (!urgent) return;
+            prefetchQueue_.erase(queued);
+        }
+        // 马上要播放的曲目排到队首，不等前面预取的曲目
+        if (urgent) {
+            prefetchQueue_.push_front(idx);
+        } else {
+            prefetchQueue_.push_back(idx);
+        }
+    }
+    if (!prefetchThread_.joinable()) {
+        stopping_ = false;
+        prefetchThread_ = thread([this]() { prefetchLoop(); });
+    }
+    prefetchCv_.notify_one();
+}
+
+void AudioManager::prefetchLoop() {
+    unique_lock<mutex> lock(prefetchMutex_);
+    for (;;) {
+        prefetchCv_.wait(lock, [this]() { return stopping_ || !prefetchQueue_.empty(); });
+        if (stopping_) return;
+        const int idx = prefetchQueue_.front();
+        prefetchQueue_.pop_front();
+        prefetching_ = idx;
+        lock.unlock();
+        // 打开文件、识别格式、初始化解码器都在这里完成，主线程播放时不再卡顿
+        Mix_Music *music = openMusic(idx);
+        lock.lock();
+        prefetched_.push_back({idx, music, 0});
+        prefetching_ = -1;
+        prefetchCv_.notify_all();
+    }
+}
+
 void AudioManager::playBGM(int idx, float volume01) {
-    Mix_VolumeMusic((int)(volume01 * MIX_MAX_VOLUME));
-    if (Mix_PlayMusic(bgms_[idx], -1) != 0) {
-        SDL_Log("Mix_PlayMusic failed: %s", Mix_GetError());
-    }   
+    if (!opened_ || idx < 0 || idx >= BGM_NUM) return; // 未初始化音频（如 headless 模式）
+    if (idx == playing_ && pending_ < 0 && Mix_PlayingMusic() && Mix_FadingMusic() != MIX_FADING_OUT) return;
+    pending_ = idx;
+    pendingVolume_ = volume01;
+    collectPrefetched();
+    const bool ready = findOpen(idx) != nullptr;
+    // 还没打开的曲目交给预取线程，主线程不等待也不自己打开
+    if (!ready) queuePrefetch(idx, true);
+    if (!Mix_PlayingMusic()) {
+        if (ready) startPending();
+    } else if (Mix_FadingMusic() != MIX_FADING_OUT) {
+        // 先淡出当前曲目，淡出结束后由 update 淡入新曲目
+        Mix_FadeOutMusic(CROSSFADE_MS / 2);
+    }
+    prefetchBGM(NEXT_BGM[idx]);
+}
+
+void AudioManager::startPending() {
+    for (auto &bgm : open_) {
+        if (bgm.idx != pending_) continue;
+        Mix_VolumeMusic((int)(pendingVolume_ * MIX_MAX_VOLUME));
+        if (Mix_FadeInMusic(bgm.music, -1, CROSSFADE_MS / 2) != 0) {
+            SDL_Log("Mix_PlayMusic failed: %s", Mix_GetError());
+        }
+        playing_ = pending_;
+        break;
+    }
+    pending_ = -1;
+    evict(); // 上一首已经停下，可以被淘汰了
+}
+
+void AudioManager::update() {
+    if (!opened_) return;
+    flushSfx();
+    collectPrefetched();
+    // 淡出已结束且预取线程已交回句柄时才开始播放
+    if (pending_ >= 0 && !Mix_PlayingMusic() && findOpen(pending_)) {
+        startPending();
+    }
 }
 
 void AudioManager::stopBGM() {
+    pending_ = -1;
     Mix_FadeOutMusic(1000);
 }
 
-void AudioManager::playHurt(float volume01) {
-    Mix_VolumeChunk(hurt_, (int)(volume01 * MIX_MAX_VOLUME));
-    if (Mix_PlayChannel(-1, hurt_, 0) == -1) {
-        SDL_Log("Mix_PlayChannel failed: %s", Mix_GetError());
+void AudioManager::playSfx(Sfx sfx, float volume01) {
+    if (!opened_) return;
+    SfxRequest &req = sfxRequests_[static_cast<int>(sfx)];
+    req.count++;
+    if (volume01 > req.volume) req.volume = volume01;
+}
+
+void AudioManager::flushSfx() {
+    sfxFrame_++;
+    // 上一帧之后播完的声道标记为空闲
+    for (int ch = 0; ch < MIX_CHANNELS; ++ch) {
+        if (voices_[ch].sfx >= 0 && !Mix_Playing(ch)) voices_[ch].sfx = -1;
+    }
+    for (int i = 0; i < SFX_NUM; ++i) {
+        SfxRequest &req = sfxRequests_[i];
+        if (req.count == 0) continue;
+        sfxStats_.requested += req.count;
+        sfxStats_.coalesced += req.count - 1;
+        const int volume = (int)(req.volume * MIX_MAX_VOLUME);
+        req = SfxRequest();
+        const int ch = pickVoice(i);
+        // 音量设在声道上而不是音效上，不影响同一音效正在播放的其他实例
+        Mix_Volume(ch, volume);
+        if (Mix_PlayChannel(ch, sfx_[i], 0) == -1) {
+            SDL_Log("Mix_PlayChannel failed: %s", Mix_GetError());
+            voices_[ch].sfx = -1;
+            continue;
+        }
+        voices_[ch] = {i, volume, sfxFrame_};
+        sfxStats_.played++;
+    }
+}
+
+int AudioManager::pickVoice(int sfx) {
+    // 同一音效已达实例上限时，重新开始它最早的那个实例
+    int instances = 0, oldestSame = -1, free = -1;
+    for (int ch = 0; ch < MIX_CHANNELS; ++ch) {
+        const Voice &v = voices_[ch];
+        if (v.sfx < 0) {
+            if (free < 0) free = ch;
+        } else if (v.sfx == sfx) {
+            instances++;
+            if (oldestSame < 0 || v.startFrame < voices_[oldestSame].startFrame) oldestSame = ch;
+        }
+    }
+    if (instances >= MAX_SFX_INSTANCES) {
+        sfxStats_.stolen++;
+        return oldestSame;
+    }
+    if (free >= 0) return free;
+    // 没有空闲声道：抢占最安静的声道，一样安静时抢占最早开始的
+    int victim = 0;
+    for (int ch = 1; ch < MIX_CHANNELS; ++ch) {
+        const Voice &v = voices_[ch], &best = voices_[victim];
+        if (v.volume < best.volume || (v.volume == best.volume && v.startFrame < best.startFrame)) victim = ch;
     }
+    sfxStats_.stolen++;
+    return victim;
 }
@@ -1,28 +1,121 @@
 #pragma once
 #include<SDL2/SDL.h>
 #include<SDL2/SDL_mixer.h>
+#include<condition_variable>
+#include<deque>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+enum class Sfx { Hurt };
+static const int SFX_NUM = 1;
+
+/**
+ * 音效统计：请求数、实际播放数、同帧合并掉的数量、抢占的声道数
+ */
+struct SfxStats {
+    int requested = 0, played = 0, coalesced = 0, stolen = 0;
+};
 
 class AudioManager {
 public:
+    static const int BGM_NUM = 6;
+    static const int BGM_MENU = 0;
+    static const int BGM_BATTLE = 2;      // 开始游戏时播放的战斗曲
+    static const int MAX_OPEN_BGM = 3;    // 同时打开的音乐句柄上限（正在播放、正在淡出、预取的下一首）
+    static const int CROSSFADE_MS = 1000; // 换曲时淡出 + 淡入的总时长
+    static const int MIX_CHANNELS = 32;
+    static const int MAX_SFX_INSTANCES = 4; // 同一音效同时播放的实例上限
+
     static AudioManager& getInstance();
 
+    /**
+     * 打开音频设备并加载音效；音乐只在这里同步打开菜单曲，其余曲目由预取线程打开
+     */
     bool init();
     /**
-     * 播放指定索引的BGM
+     * 关闭预取线程并释放所有音乐，退出前调用
+     */
+    void quit();
+    /**
+     * 播放指定索引的BGM，已有音乐在播放时先淡出再淡入新曲目，不阻塞主线程
+     * 曲目还没打开时交给预取线程，打开后由 update 开始播放；播放后在后台预取下一首可能播放的曲目
      * @param idx BGM索引，范围[0, 5]
      */
     void playBGM(int idx, float volume01 = 1.0f);
     void stopBGM();
-    void playHurt(float volume01 = 1.0f);
+    void playHurt(float volume01 = 1.0f) { playSfx(Sfx::Hurt, volume01); }
+    /**
+     * 请求播放音效：只记入本帧的请求队列，同一帧内相同音效合并为一次（取最大音量），由 update 统一提交给混音器
+     */
+    void playSfx(Sfx sfx, float volume01 = 1.0f);
+    /**
+     * 在后台线程打开指定曲目，之后 playBGM 可以立即开始播放
+     */
+    void prefetchBGM(int idx);
+    /**
+     * 主线程每帧调用：提交本帧的音效请求，接收预取完成的曲目，淡出结束后开始淡入下一首
+     */
+    void update();
+
+    const SfxStats &sfxStats() const { return sfxStats_; }
+    void resetSfxStats() { sfxStats_ = SfxStats(); }
 
 private:
-    static const char *BGM_FILES[6];
+    static const char *BGM_FILES[BGM_NUM];
+    static const char *SFX_FILES[SFX_NUM];
+    static const int NEXT_BGM[BGM_NUM];
 
     AudioManager() = default;
     ~AudioManager() = default;
 
+    struct OpenBgm {
+        int idx;
+        Mix_Music *music;
+        Uint32 lastUsed; // LRU 时间戳
+    };
+
     bool loadAudioAssets();
+    static Mix_Music *openMusic(int idx);
+    Mix_Music *findOpen(int idx);
+    void queuePrefetch(int idx, bool urgent);
+    void insertOpen(int idx, Mix_Music *music);
+    void evict();
+    void collectPrefetched();
+    void prefetchLoop();
+    void startPending();
+    void flushSfx();
+    int pickVoice(int sfx);
+
+    bool opened_ = false;
+    std::vector<OpenBgm> open_; // 只在主线程访问
+    Uint32 useClock_ = 0;
+    int playing_ = -1;          // 正在播放（或淡出中）的曲目
+    int pending_ = -1;          // 等当前曲目淡出、且句柄打开后要播放的曲目
+    float pendingVolume_ = 1.0f;
+
+    // 音效：每帧的合并请求与各声道上正在播放的内容，只在主线程访问
+    struct SfxRequest {
+        int count = 0;
+        float volume = 0;
+    };
+    struct Voice {
+        int sfx = -1;          // -1 表示空闲
+        int volume = 0;
+        Uint32 startFrame = 0;
+    };
+    Mix_Chunk *sfx_[SFX_NUM]{};
+    SfxRequest sfxRequests_[SFX_NUM];
+    Voice voices_[MIX_CHANNELS];
+    Uint32 sfxFrame_ = 0;
+    SfxStats sfxStats_;
 
-    Mix_Music *bgms_[6]{};
-    Mix_Chunk *hurt_{};
+    // 预取线程，以下由 prefetchMutex_ 保护
+    std::mutex prefetchMutex_;
+    std::condition_variable prefetchCv_;
+    std::deque<int> prefetchQueue_;
+    std::vector<OpenBgm> prefetched_;
+    int prefetching_ = -1;      // 预取线程正在打开的曲目
+    bool stopping_ = false;
+    std::thread prefetchThread_;
 };
@@ -0,0 +1,672 @@
+#include "benchmark.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "constants.h"
+#include "spatial_grid.h"
+#include "sprite_batch.h"
+#include "resource_cache.h"
+#include "enemy_swarm.h"
+#include "character.h"
+#include "worker_pool.h"
+#include "steering.h"
+#include "flow_field.h"
+#include "audio_manager.h"
+#include "camera.h"
+using namespace std;
+using namespace std::chrono;
+
+static const int BENCH_FRAMES = 200;
+
+// 模拟一帧的敌人分布：整屏随机散布，每帧小幅移动
+static void makeEnemyRects(vector<SDL_Rect> &rects, int count, mt19937 &rng) {
+    uniform_int_distribution<int> distX(-64, SCREEN_WIDTH);
+    uniform_int_distribution<int> distY(-64, SCREEN_HEIGHT);
+    rects.resize(count);
+    for (auto &r : rects) r = {distX(rng), distY(rng), 64, 64};
+}
+
+static void jitterRects(vector<SDL_Rect> &rects, mt19937 &rng) {
+    uniform_int_distribution<int> step(-2, 2);
+    for (auto &r : rects) {
+        r.x += step(rng);
+        r.y += step(rng);
+    }
+}
+
+static void makeGuardianRects(SDL_Rect *out, int count, int frame) {
+    const int cx = SCREEN_WIDTH / 2, cy = SCREEN_HEIGHT / 2;
+    for (int g = 0; g < count; ++g) {
+        const double deg = frame * 1.6 + g * 360.0 / count;
+        const double radius = 20 + (frame % 80);
+        out[g] = {int(cx + radius * cos(deg * M_PI / 180.0)) - 5, int(cy + radius * sin(deg * M_PI / 180.0)) - 5, 11, 11};
+    }
+}
+
+static void benchCollision() {
+    const int counts[] = {100, 1000, 10000};
+    const int guardianCounts[] = {3, 32};
+    const SDL_Rect heroRect = {SCREEN_WIDTH / 2 - 32, SCREEN_HEIGHT / 2 - 32, 64, 64};
+    printf("collision: guardians + hero vs N enemies, %d frames\n", BENCH_FRAMES);
+    printf("%9s %8s %14s %14s %10s\n", "guardians", "enemies", "naive ms/frm", "grid ms/frm", "hits");
+    for (int guardianNum : guardianCounts)
+    for (int count : counts) {
+        mt19937 rng(12345);
+        vector<SDL_Rect> rects;
+        makeEnemyRects(rects, count, rng);
+        vector<SDL_Rect> guardianRects(guardianNum);
+        SpatialGrid grid;
+        vector<int> candidates;
+        long naiveHits = 0, gridHits = 0;
+        nanoseconds naiveTime(0), gridTime(0);
+        for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+            jitterRects(rects, rng);
+            makeGuardianRects(guardianRects.data(), guardianNum, frame);
+
+            auto t0 = steady_clock::now();
+            for (const auto &r : rects) {
+                if (SDL_HasIntersection(&r, &heroRect)) naiveHits++;
+            }
+            for (const auto &g : guardianRects) {
+                for (const auto &r : rects) {
+                    if (SDL_HasIntersection(&g, &r)) naiveHits++;
+                }
+            }
+            auto t1 = steady_clock::now();
+            grid.clear();
+            for (int i = 0; i < count; ++i) grid.insert(i, rects[i]);
+            grid.build();
+            grid.query(heroRect, candidates);
+            for (int i : candidates) {
+                if (SDL_HasIntersection(&rects[i], &heroRect)) gridHits++;
+            }
+            for (const auto &g : guardianRects) {
+                grid.query(g, candidates);
+                for (int i : candidates) {
+                    if (SDL_HasIntersection(&g, &rects[i])) gridHits++;
+                }
+            }
+            auto t2 = steady_clock::now();
+            naiveTime += t1 - t0;
+            gridTime += t2 - t1;
+        }
+        printf("%9d %8d %14.4f %14.4f %10ld%s\n", guardianNum, count,
+               duration<double, milli>(naiveTime).count() / BENCH_FRAMES,
+               duration<double, milli>(gridTime).count() / BENCH_FRAMES,
+               gridHits, naiveHits == gridHits ? "" : "  MISMATCH");
+    }
+}
+
+// 离屏软件渲染器，供需要加载纹理的基准使用，不创建窗口
+static SDL_Surface *benchTarget = nullptr;
+
+static SDL_Renderer *openBenchRenderer() {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        printf("SDL Init Error: %s\n", SDL_GetError());
+        return nullptr;
+    }
+    IMG_Init(IMG_INIT_PNG);
+    benchTarget = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *r = benchTarget ? SDL_CreateSoftwareRenderer(benchTarget) : nullptr;
+    if (!r) {
+        printf("SDL Create Renderer Error: %s\n", SDL_GetError());
+    }
+    return r;
+}
+
+static void closeBenchRenderer(SDL_Renderer *r) {
+    TextureCache::getInstance().clear();
+    AtlasIndexCache::getInstance().clear();
+    if (r) SDL_DestroyRenderer(r);
+    if (benchTarget) SDL_FreeSurface(benchTarget);
+    benchTarget = nullptr;
+    IMG_Quit();
+    SDL_Quit();
+}
+
+// 软件渲染器下绘制 5000 个敌人精灵：逐个 SDL_RenderCopy vs SpriteBatch
+static int benchBatch() {
+    const int SPRITES = 5000;
+    const int FRAMES = 100;
+    SDL_Renderer *r = openBenchRenderer();
+    if (!r) {
+        closeBenchRenderer(r);
+        return 1;
+    }
+    int result = 0;
+    {
+        shared_ptr<const AnimArchetype> arch = EnemySwarm::archetype(r);
+        if (!arch) {
+            result = 1;
+        } else {
+            // 5 种状态的纹理混合出现，与实际游戏中敌人状态各异的情形一致
+            struct Sprite { const AnimClip *clip; SDL_Rect dst; int row, col; };
+            vector<Sprite> sprites(SPRITES);
+            mt19937 rng(12345);
+            uniform_int_distribution<int> distX(-32, SCREEN_WIDTH - 32), distY(-32, SCREEN_HEIGHT - 32), distState(0, ANIM_STATE_NUM - 1);
+            for (auto &sp : sprites) {
+                sp.clip = arch->clip(static_cast<AnimState>(distState(rng)));
+                sp.dst = {distX(rng), distY(rng), EnemySwarm::SIZE, EnemySwarm::SIZE};
+                sp.row = sp.dst.x & 3;
+                sp.col = sp.dst.y % sp.clip->atlasIndex->cols;
+            }
+            SpriteBatch batch;
+            int copyCalls = 0;
+            auto t0 = steady_clock::now();
+            for (int f = 0; f < FRAMES; ++f) {
+                SDL_RenderClear(r);
+                for (const auto &sp : sprites) {
+                    SDL_RenderCopy(r, sp.clip->texture.get(), &sp.clip->atlasIndex->frame(sp.row, sp.col), &sp.dst);
+                    copyCalls++;
+                }
+                SDL_RenderPresent(r);
+            }
+            auto t1 = steady_clock::now();
+            for (int f = 0; f < FRAMES; ++f) {
+                SDL_RenderClear(r);
+                batch.begin(r);
+                for (const auto &sp : sprites) {
+                    batch.draw(sp.clip->texture.get(), sp.clip->atlasIndex->frame(sp.row, sp.col), sp.dst);
+                }
+                batch.flush();
+                SDL_RenderPresent(r);
+            }
+            auto t2 = steady_clock::now();
+            printf("batch: %d sprites, software renderer, %d frames\n", SPRITES, FRAMES);
+            printf("%-16s %12s %12s\n", "path", "draws/frame", "ms/frame");
+            printf("%-16s %12d %12.3f\n", "SDL_RenderCopy", copyCalls / FRAMES, duration<double, milli>(t1 - t0).count() / FRAMES);
+            printf("%-16s %12d %12.3f\n", "SpriteBatch", batch.stats().drawCalls / FRAMES, duration<double, milli>(t2 - t1).count() / FRAMES);
+        }
+    }
+    closeBenchRenderer(r);
+    return result;
+}
+
+// 敌人更新在 1..N 个线程下的耗时，并校验各线程数下的模拟结果完全一致
+static int benchUpdate() {
+    const int counts[] = {10000, 100000};
+    const int STEPS = 120;
+    SDL_Renderer *r = openBenchRenderer();
+    if (!r) {
+        closeBenchRenderer(r);
+        return 1;
+    }
+    int maxThreads = (int)thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    int result = 0;
+    printf("update: EnemySwarm::update, %d steps of %.2f ms, hardware threads: %d\n", STEPS, SIM_STEP_MS, maxThreads);
+    printf("%8s %8s %12s %9s %20s\n", "enemies", "threads", "ms/step", "speedup", "checksum");
+    for (int count : counts) {
+        double baseMs = 0;
+        unsigned long long baseSum = 0;
+        for (int threads : threadCounts) {
+            Hero hero;
+            EnemySwarm swarm;
+            if (!hero.init(r, SCREEN_WIDTH / 2 - Hero::SIZE / 2, SCREEN_HEIGHT / 2 - Hero::SIZE / 2) || !swarm.init(r, count)) {
+                result = 1;
+                break;
+            }
+            swarm.setTarget(&hero);
+            mt19937 rng(12345);
+            uniform_real_distribution<float> distX(0, SCREEN_WIDTH - EnemySwarm::SIZE), distY(0, SCREEN_HEIGHT - EnemySwarm::SIZE);
+            for (int i = 0; i < count; ++i) {
+                const float x = distX(rng);
+                swarm.spawn(x, distY(rng));
+            }
+            WorkerPool pool;
+            pool.start(threads);
+            auto t0 = steady_clock::now();
+            for (int step = 0; step < STEPS; ++step) {
+                swarm.beginStep();
+                swarm.update(SIM_STEP_MS, &pool);
+            }
+            auto t1 = steady_clock::now();
+            unsigned long long sum = hero.getHp();
+            for (int i = 0; i < swarm.size(); ++i) {
+                const SDL_Rect rect = swarm.getHitRect(i);
+                sum = sum * 31 + unsigned(rect.x) * 7919u + unsigned(rect.y) + static_cast<unsigned>(swarm.getState(i));
+            }
+            const double ms = duration<double, milli>(t1 - t0).count() / STEPS;
+            if (threads == 1) {
+                baseMs = ms;
+                baseSum = sum;
+            }
+            printf("%8d %8d %12.3f %8.2fx %20llu%s\n", count, threads, ms, baseMs / ms, sum, sum == baseSum ? "" : "  MISMATCH");
+        }
+    }
+    closeBenchRenderer(r);
+    return result;
+}
+
+// 追踪移动内核：各实现的耗时，以及与标量版本逐位比较的结果
+static int benchSteer() {
+    const int counts[] = {1000, 10000, 100000};
+    const int STEPS = 500;
+    SeekParams p;
+    p.targetX = SCREEN_WIDTH / 2;
+    p.targetY = SCREEN_HEIGHT / 2;
+    p.halfSize = EnemySwarm::SIZE / 2;
+    p.speed = 60;
+    p.dt_ms = SIM_STEP_MS;
+    p.attackRange = EnemySwarm::ATTACK_RANGE;
+    p.maxX = SCREEN_WIDTH - EnemySwarm::SIZE;
+    p.maxY = SCREEN_HEIGHT - EnemySwarm::SIZE;
+    const vector<SeekKernel> kernels = availableSeekKernels();
+    int result = 0;
+    printf("steer: seek-and-move kernel, %d steps, best: %s\n", STEPS, bestSeekKernel().name);
+    printf("%8s %5s %8s %12s %10s %9s %8s\n", "enemies", "flow", "kernel", "us/step", "ns/enemy", "speedup", "match");
+    for (bool useFlow : {false, true})
+    for (int count : counts) {
+        // 初始位置覆盖屏幕内外，约一成敌人不参与追踪（攻击/死亡中）
+        mt19937 rng(12345);
+        uniform_real_distribution<float> distX(-200, SCREEN_WIDTH + 200), distY(-200, SCREEN_HEIGHT + 200);
+        vector<float> x0(count), y0(count);
+        vector<uint8_t> moving(count);
+        // 流场方向：一半敌人取 8 个方向之一，另一半为 (0, 0) 直接追踪
+        vector<float> flowX(count), flowY(count);
+        for (int i = 0; i < count; ++i) {
+            x0[i] = distX(rng);
+            y0[i] = distY(rng);
+            moving[i] = rng() % 10 != 0;
+            if (rng() % 2) {
+                const float deg = (rng() % 8) * 45.0f;
+                flowX[i] = cosf(deg * float(M_PI) / 180.0f);
+                flowY[i] = sinf(deg * float(M_PI) / 180.0f);
+            }
+        }
+        vector<float> refX, refY, refVx, refVy;
+        vector<uint8_t> refArrived;
+        double baseUs = 0;
+        for (const SeekKernel &k : kernels) {
+            vector<float> x = x0, y = y0, vx(count), vy(count);
+            vector<uint8_t> arrived(count);
+            auto t0 = steady_clock::now();
+            for (int step = 0; step < STEPS; ++step) {
+                k.fn(p, x.data(), y.data(), vx.data(), vy.data(), useFlow ? flowX.data() : nullptr, useFlow ? flowY.data() : nullptr,
+                     moving.data(), arrived.data(), count);
+            }
+            const double us = duration<double, micro>(steady_clock::now() - t0).count() / STEPS;
+            bool match = true;
+            if (refX.empty()) {
+                refX = x; refY = y; refVx = vx; refVy = vy; refArrived = arrived;
+                baseUs = us;
+            } else {
+                match = memcmp(x.data(), refX.data(), count * sizeof(float)) == 0
+                     && memcmp(y.data(), refY.data(), count * sizeof(float)) == 0
+                     && memcmp(vx.data(), refVx.data(), count * sizeof(float)) == 0
+                     && memcmp(vy.data(), refVy.data(), count * sizeof(float)) == 0
+                     && arrived == refArrived;
+            }
+            if (!match) result = 1;
+            printf("%8d %5s %8s %12.2f %10.3f %8.2fx %8s\n", count, useFlow ? "yes" : "no", k.name, us, us * 1000.0 / count, baseUs / us, match ? "yes" : "MISMATCH");
+        }
+    }
+    return result;
+}
+
+// 流场：目标换格子时的重算耗时，以及敌人查表的单个耗时（应与敌人数量无关）
+static void benchFlow() {
+    const int counts[] = {1000, 10000, 100000};
+    const int REBUILDS = 200;
+    const int STEPS = 200;
+    FlowField field;
+    field.init(SCREEN_WIDTH, SCREEN_HEIGHT);
+    // 一堵带缺口的竖墙，迫使流场绕行
+    for (int cy = 0; cy < field.rows() - 3; ++cy) {
+        field.setBlocked(field.cols() / 2, cy, true);
+    }
+    auto t0 = steady_clock::now();
+    for (int r = 0; r < REBUILDS; ++r) {
+        field.setGoal((r * FlowField::DEFAULT_CELL_SIZE) % SCREEN_WIDTH, SCREEN_HEIGHT / 3);
+    }
+    const double rebuildUs = duration<double, micro>(steady_clock::now() - t0).count() / REBUILDS;
+    printf("flow: %dx%d cells of %d px, rebuild %.2f us (%d rebuilds)\n", field.cols(), field.rows(), field.cellSize(), rebuildUs, field.rebuildCount());
+    printf("%8s %12s %10s\n", "enemies", "us/step", "ns/enemy");
+    for (int count : counts) {
+        mt19937 rng(12345);
+        uniform_real_distribution<float> distX(0, SCREEN_WIDTH), distY(0, SCREEN_HEIGHT);
+        vector<float> x(count), y(count), fx(count), fy(count);
+        for (int i = 0; i < count; ++i) {
+            x[i] = distX(rng);
+            y[i] = distY(rng);
+        }
+        auto t1 = steady_clock::now();
+        for (int step = 0; step < STEPS; ++step) {
+            for (int i = 0; i < count; ++i) {
+                const int cell = field.cellAt(x[i], y[i]);
+                fx[i] = cell >= 0 ? field.dirX(cell) : 0;
+                fy[i] = cell >= 0 ? field.dirY(cell) : 0;
+            }
+        }
+        const double us = duration<double, micro>(steady_clock::now() - t1).count() / STEPS;
+        printf("%8d %12.2f %10.3f\n", count, us, us * 1000.0 / count);
+    }
+}
+
+// 资源缓存查找：旧的 ostringstream 拼接字符串键 vs 按路径登记 vs 直接用句柄
+static int benchCache() {
+    const int LOOKUPS = 1000000;
+    const char *paths[] = {
+        Hero::IDLE_PATH, Hero::WALK_PATH, Hero::HURT_PATH, Hero::ATTACK_PATH, Hero::DEATH_PATH,
+        EnemySwarm::IDLE_PATH, EnemySwarm::WALK_PATH, EnemySwarm::HURT_PATH, EnemySwarm::ATTACK_PATH, EnemySwarm::DEATH_PATH,
+    };
+    const int PATHS = sizeof(paths) / sizeof(paths[0]);
+    SDL_Renderer *r = openBenchRenderer();
+    if (!r) {
+        closeBenchRenderer(r);
+        return 1;
+    }
+    int result = 0;
+    {
+        TextureCache &textures = TextureCache::getInstance();
+        AtlasIndexCache &atlases = AtlasIndexCache::getInstance();
+        vector<shared_ptr<SDL_Texture>> held;
+        vector<shared_ptr<const AtlasIndex>> heldAtlas;
+        vector<TextureId> textureIds;
+        vector<AtlasId> atlasIds;
+        // 旧实现：每次查找都用 ostringstream 拼出键再查 unordered_map<string, weak_ptr>
+        unordered_map<string, weak_ptr<SDL_Texture>> legacyTextures;
+        unordered_map<string, weak_ptr<const AtlasIndex>> legacyAtlases;
+        try {
+            for (const char *path : paths) {
+                held.push_back(textures.get(r, path));
+                heldAtlas.push_back(atlases.get(held.back().get(), path, EnemySwarm::SIZE, EnemySwarm::SIZE, 0, 0, 1, 4));
+                textureIds.push_back(textures.intern(r, path));
+                atlasIds.push_back(atlases.intern(path, EnemySwarm::SIZE, EnemySwarm::SIZE, 0, 0, 1, 4));
+                ostringstream tk, ak;
+                tk << r << '|' << path;
+                ak << path << '#' << EnemySwarm::SIZE << '#' << EnemySwarm::SIZE << '#' << 0 << '#' << 0 << '#' << 1 << '#' << 4;
+                legacyTextures[tk.str()] = held.back();
+                legacyAtlases[ak.str()] = heldAtlas.back();
+            }
+        } catch (const exception &e) {
+            printf("%s\n", e.what());
+            result = 1;
+        }
+        if (result == 0) {
+            printf("cache: %d lookups over %d paths\n", LOOKUPS, PATHS);
+            printf("%-24s %10s %10s\n", "path", "ns/tex", "ns/atlas");
+            uintptr_t checksum = 0;
+            auto t0 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                ostringstream oss;
+                oss << r << '|' << paths[i % PATHS];
+                checksum += (uintptr_t)legacyTextures[oss.str()].lock().get();
+            }
+            auto t1 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                ostringstream oss;
+                oss << paths[i % PATHS] << '#' << EnemySwarm::SIZE << '#' << EnemySwarm::SIZE << '#' << 0 << '#' << 0 << '#' << 1 << '#' << 4;
+                checksum += (uintptr_t)legacyAtlases[oss.str()].lock().get();
+            }
+            auto t2 = steady_clock::now();
+            printf("%-24s %10.1f %10.1f\n", "ostringstream key", duration<double, nano>(t1 - t0).count() / LOOKUPS,
+                   duration<double, nano>(t2 - t1).count() / LOOKUPS);
+            t0 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                checksum += (uintptr_t)textures.get(r, paths[i % PATHS]).get();
+            }
+            t1 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                checksum += (uintptr_t)atlases.get(held[i % PATHS].get(), paths[i % PATHS], EnemySwarm::SIZE, EnemySwarm::SIZE, 0, 0, 1, 4).get();
+            }
+            t2 = steady_clock::now();
+            printf("%-24s %10.1f %10.1f\n", "intern per call", duration<double, nano>(t1 - t0).count() / LOOKUPS,
+                   duration<double, nano>(t2 - t1).count() / LOOKUPS);
+            t0 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                checksum += (uintptr_t)textures.get(textureIds[i % PATHS]).get();
+            }
+            t1 = steady_clock::now();
+            for (int i = 0; i < LOOKUPS; ++i) {
+                checksum += (uintptr_t)atlases.get(atlasIds[i % PATHS], held[i % PATHS].get()).get();
+            }
+            t2 = steady_clock::now();
+            printf("%-24s %10.1f %10.1f\n", "handle", duration<double, nano>(t1 - t0).count() / LOOKUPS,
+                   duration<double, nano>(t2 - t1).count() / LOOKUPS);
+            printf("checksum %zx\n", (size_t)checksum);
+        }
+    }
+    closeBenchRenderer(r);
+    return result;
+}
+
+// 大地图视口裁剪：敌人散布在整个世界，视口取整个世界（全部渲染、全部推进动画）vs 摄像机视口
+static int benchCull() {
+    const int counts[] = {10000, 50000};
+    const int FRAMES = 60;
+    SDL_Renderer *r = openBenchRenderer();
+    if (!r) {
+        closeBenchRenderer(r);
+        return 1;
+    }
+    int result = 0;
+    printf("cull: enemies spread over a %dx%d world, view %dx%d, %d frames\n", WORLD_WIDTH, WORLD_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT, FRAMES);
+    printf("%8s %-8s %8s %14s %14s\n", "enemies", "view", "drawn", "render ms/frm", "update ms/step");
+    for (int count : counts)
+    for (int culled = 0; culled < 2 && result == 0; ++culled) {
+        Hero hero;
+        EnemySwarm swarm;
+        if (!hero.init(r, WORLD_WIDTH / 2 - Hero::SIZE / 2, WORLD_HEIGHT / 2 - Hero::SIZE / 2) || !swarm.init(r, count)) {
+            result = 1;
+            break;
+        }
+        swarm.setTarget(&hero);
+        mt19937 rng(12345);
+        uniform_real_distribution<float> distX(0, WORLD_WIDTH - EnemySwarm::SIZE), distY(0, WORLD_HEIGHT - EnemySwarm::SIZE);
+        for (int i = 0; i < count; ++i) {
+            const float x = distX(rng);
+            swarm.spawn(x, distY(rng));
+        }
+        Camera camera;
+        camera.setWorldSize(WORLD_WIDTH, WORLD_HEIGHT);
+        camera.setViewSize(culled ? SCREEN_WIDTH : WORLD_WIDTH, culled ? SCREEN_HEIGHT : WORLD_HEIGHT);
+        camera.lookAt(hero.center().x, hero.center().y);
+        swarm.setAnimView(camera.view());
+        auto t0 = steady_clock::now();
+        for (int f = 0; f < FRAMES; ++f) {
+            swarm.beginStep();
+            swarm.update(SIM_STEP_MS);
+        }
+        auto t1 = steady_clock::now();
+        SpriteBatch batch;
+        int drawn = 0;
+        for (int f = 0; f < FRAMES; ++f) {
+            SDL_RenderClear(r);
+            batch.begin(r);
+            drawn = swarm.render(batch, camera, 1.0f);
+            batch.flush();
+            SDL_RenderPresent(r);
+        }
+        auto t2 = steady_clock::now();
+        printf("%8d %-8s %8d %14.3f %14.3f\n", count, culled ? "screen" : "world", drawn,
+               duration<double, milli>(t2 - t1).count() / FRAMES, duration<double, milli>(t1 - t0).count() / FRAMES);
+    }
+    closeBenchRenderer(r);
+    return result;
+}
+
+// 敌人 LOD：敌人散布在整个世界，每步都全部更新 vs 按距离分级的固定间隔 vs 按预算调整间隔
+static int benchLod() {
+    const int counts[] = {10000, 50000};
+    const int STEPS = 240;
+    const int BUDGET_US = 500;
+    SDL_Renderer *r = openBenchRenderer();
+    if (!r) {
+        closeBenchRenderer(r);
+        return 1;
+    }
+    const char *modes[] = {"off", "fixed", "budget"};
+    int result = 0;
+    printf("lod: enemies spread over a %dx%d world, %d steps, budget mode targets %d us/step\n", WORLD_WIDTH, WORLD_HEIGHT, STEPS, BUDGET_US);
+    printf("%8s %-8s %12s %14s %8s %16s\n", "enemies", "lod", "us/step", "steered/step", "shift", "mean dist px");
+    for (int count : counts)
+    for (int mode = 0; mode < 3 && result == 0; ++mode) {
+        Hero hero;
+        EnemySwarm swarm;
+        if (!hero.init(r, WORLD_WIDTH / 2 - Hero::SIZE / 2, WORLD_HEIGHT / 2 - Hero::SIZE / 2) || !swarm.init(r, count)) {
+            result = 1;
+            break;
+        }
+        swarm.setTarget(&hero);
+        // 与游戏中一样按流场前进，流场只算一次
+        FlowField field;
+        field.init(WORLD_WIDTH, WORLD_HEIGHT);
+        field.setGoal(hero.center().x, hero.center().y);
+        swarm.setFlowField(&field);
+        SwarmLod lod;
+        lod.enabled = mode != 0;
+        lod.budgetUs = mode == 2 ? BUDGET_US : 0;
+        swarm.setLod(lod);
+        mt19937 rng(12345);
+        uniform_real_distribution<float> distX(0, WORLD_WIDTH - EnemySwarm::SIZE), distY(0, WORLD_HEIGHT - EnemySwarm::SIZE);
+        for (int i = 0; i < count; ++i) {
+            const float x = distX(rng);
+            swarm.spawn(x, distY(rng));
+        }
+        long long steered = 0;
+        auto t0 = steady_clock::now();
+        for (int step = 0; step < STEPS; ++step) {
+            swarm.beginStep();
+            swarm.update(SIM_STEP_MS);
+            steered += swarm.lodStats().steered;
+        }
+        auto t1 = steady_clock::now();
+        // 远处敌人更新得稀，但沿上次速度继续走，平均距离应与全部更新时接近
+        const SDL_Point c = hero.center();
+        double dist = 0;
+        for (int i = 0; i < swarm.size(); ++i) {
+            const SDL_Rect rect = swarm.getHitRect(i);
+            dist += hypot(rect.x + EnemySwarm::SIZE / 2.0 - c.x, rect.y + EnemySwarm::SIZE / 2.0 - c.y);
+        }
+        printf("%8d %-8s %12.1f %14.0f %8d %16.1f\n", count, modes[mode], duration<double, micro>(t1 - t0).count() / STEPS,
+               double(steered) / STEPS, swarm.lodStats().extraShift, dist / max(swarm.size(), 1));
+    }
+    closeBenchRenderer(r);
+    return result;
+}
+
+// 混音线程耗时：音乐钩子在每次混音回调开头调用，PostMix 在声道混合完之后调用，两者之差即声道混合耗时
+static atomic<Uint64> mixBegin{0}, mixTicks{0}, mixCallbacks{0};
+
+static void benchMixBegin(void *, Uint8 *stream, int len) {
+    memset(stream, 0, len);
+    mixBegin = SDL_GetPerformanceCounter();
+}
+
+static void benchMixEnd(void *, Uint8 *, int) {
+    mixTicks += SDL_GetPerformanceCounter() - mixBegin;
+    mixCallbacks++;
+}
+
+// 每帧大量受击音效：直接 Mix_PlayChannel vs 每帧合并后由 AudioManager 分配声道
+static int benchMixer() {
+    const int FRAMES = 120;
+    const int hitCounts[] = {1, 50, 500};
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0); // 没有声卡也能跑，混音线程照常按实时节奏工作
+    if (SDL_Init(SDL_INIT_AUDIO) != 0) {
+        printf("SDL Init Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    AudioManager &audio = AudioManager::getInstance();
+    if (!audio.init()) {
+        SDL_Quit();
+        return 1;
+    }
+    Mix_Chunk *direct = Mix_LoadWAV("../aud/hurt.wav");
+    if (!direct) {
+        printf("Mix_LoadWAV failed: %s\n", Mix_GetError());
+        audio.quit();
+        SDL_Quit();
+        return 1;
+    }
+    Mix_HookMusic(benchMixBegin, nullptr);
+    Mix_SetPostMix(benchMixEnd, nullptr);
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    printf("mixer: hurt sound requests per frame, %d frames at 60 fps, %d channels\n", FRAMES, AudioManager::MIX_CHANNELS);
+    printf("%6s %-8s %12s %12s %10s %8s %8s\n", "hits", "path", "main us/frm", "mix us/cb", "voices", "played", "stolen");
+    for (int hits : hitCounts)
+    for (int queued = 0; queued < 2; ++queued) {
+        Mix_HaltChannel(-1);
+        SDL_Delay(100);
+        audio.resetSfxStats();
+        mixTicks = 0;
+        mixCallbacks = 0;
+        Uint64 mainTicks = 0;
+        long voices = 0;
+        int played = 0;
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            const Uint64 t0 = SDL_GetPerformanceCounter();
+            for (int i = 0; i < hits; ++i) {
+                if (queued) {
+                    audio.playHurt(0.5f);
+                } else {
+                    Mix_VolumeChunk(direct, MIX_MAX_VOLUME / 2);
+                    if (Mix_PlayChannel(-1, direct, 0) != -1) played++;
+                }
+            }
+            if (queued) audio.update();
+            mainTicks += SDL_GetPerformanceCounter() - t0;
+            voices += Mix_Playing(-1);
+            SDL_Delay(16);
+        }
+        if (queued) played = audio.sfxStats().played;
+        const Uint64 callbacks = max<Uint64>(mixCallbacks, 1);
+        printf("%6d %-8s %12.1f %12.1f %10.1f %8d %8d\n", hits, queued ? "queued" : "direct", mainTicks * 1e6 / freq / FRAMES,
+               mixTicks * 1e6 / freq / callbacks, (double)voices / FRAMES, played, queued ? audio.sfxStats().stolen : 0);
+    }
+    Mix_SetPostMix(nullptr, nullptr);
+    Mix_HookMusic(nullptr, nullptr);
+    Mix_HaltChannel(-1);
+    Mix_FreeChunk(direct);
+    audio.quit();
+    SDL_Quit();
+    return 0;
+}
+
+int runBenchmark(const char *name) {
+    if (strcmp(name, "collision") == 0) {
+        benchCollision();
+        return 0;
+    }
+    if (strcmp(name, "batch") == 0) {
+        return benchBatch();
+    }
+    if (strcmp(name, "update") == 0) {
+        return benchUpdate();
+    }
+    if (strcmp(name, "steer") == 0) {
+        return benchSteer();
+    }
+    if (strcmp(name, "flow") == 0) {
+        benchFlow();
+        return 0;
+    }
+    if (strcmp(name, "cache") == 0) {
+        return benchCache();
+    }
+    if (strcmp(name, "cull") == 0) {
+        return benchCull();
+    }
+    if (strcmp(name, "lod") == 0) {
+        return benchLod();
+    }
+    if (strcmp(name, "mixer") == 0) {
+        return benchMixer();
+    }
+    printf("unknown benchmark: %s\n", name);
+    printf("available: collision, batch, update, steer, flow, cache, cull, lod, mixer\n");
+    return 1;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * 运行指定名称的基准测试，结果输出到标准输出
+ * 用法：./main --bench <name>
+ * @return 进程退出码
+ */
+int runBenchmark(const char *name);
@@ -6,11 +6,13 @@ const SDL_Point Guardian::PIVOT = {Guardian::SIZE / 2, Guardian::SIZE / 2};
 bool Guardian::init(SDL_Renderer *r) {
     renderer_ = r;
     bulletAtlas_.texture = TextureCache::getInstance().get(r, ATLAS_PATH);
-    bulletAtlas_.atlasIndex = AtlasIndexCache::getInstance().get(bulletAtlas_.texture.get(), ATLAS_PATH, SIZE, SIZE, START_X, START_Y, 1, FRAME_NUM);
+    bulletAtlas_.atlasIndex = AtlasIndexCache::getInstance().get(bulletAtlas_.texture.get(), ATLAS_PATH, ClipGrid<SIZE, SIZE, START_X, START_Y, 1, FRAME_NUM>::DESC);
     return true;
 }
 
-void Guardian::update(int dt_ms) {
+void Guardian::update(float dt_ms) {
+    prevPos_ = {dstRect_.x, dstRect_.y};
+    prevSpinDeg_ = spinDeg_;
     if (target_) {
         center_ = target_->center();
     }
@@ -24,13 +26,21 @@ void Guardian::update(int dt_ms) {
     if (radius_ <= RADIUS_MIN) radiusSpeedPerSec_ = abs(radiusSpeedPerSec_);
 }
 
-void Guardian::render() {
-    auto srcRect_ = bulletAtlas_.atlasIndex->frames[0][frameIndex];
-    SDL_RenderCopyEx(renderer_, bulletAtlas_.texture.get(), &srcRect_, &dstRect_, spinDeg_, &PIVOT, SDL_FLIP_NONE);
+void Guardian::render(SpriteBatch &batch, const Camera &camera, float alpha) {
+    auto srcRect_ = bulletAtlas_.atlasIndex->frame(0, frameIndex);
+    SDL_Rect dst = dstRect_;
+    dst.x = int(prevPos_.x + (dstRect_.x - prevPos_.x) * alpha);
+    dst.y = int(prevPos_.y + (dstRect_.y - prevPos_.y) * alpha);
+    // 绕中心旋转，旋转后的外接框不超过边长的 1.5 倍，按这个余量判断可见
+    const SDL_Rect bounds = {dst.x - dst.w / 4, dst.y - dst.h / 4, dst.w * 3 / 2, dst.h * 3 / 2};
+    if (!camera.visible(bounds)) return;
+    const float spin = prevSpinDeg_ + (spinDeg_ - prevSpinDeg_) * alpha;
+    batch.drawRotated(bulletAtlas_.texture.get(), srcRect_, camera.toScreen(dst), spin, PIVOT);
 }
 
-void Guardian::checkCollision(Enemy &enemy) {
-    if (SDL_HasIntersection(&dstRect_, enemy.getHitRect())) {
-        enemy.damage(10);
+void Guardian::checkCollision(EnemySwarm &enemies, int i) {
+    const SDL_Rect rect = enemies.getHitRect(i);
+    if (SDL_HasIntersection(&dstRect_, &rect)) {
+        enemies.damage(i, 10);
     }
 }
@@ -3,6 +3,8 @@
 #include <memory>
 #include "resource_cache.h"
 #include "character.h"
+#include "enemy_swarm.h"
+#include "sprite_batch.h"
 using namespace std;
 
 struct BulletAtlas {
@@ -22,12 +24,16 @@ public:
     static const int RADIUS_MIN = 20;
 
     bool init(SDL_Renderer *r);
-    void update(int dt_ms);
-    void render();
+    void update(float dt_ms);
+    /**
+     * 渲染，alpha 为上一步到当前步之间的插值系数 [0, 1]；不在视口内时跳过
+     */
+    void render(SpriteBatch &batch, const Camera &camera, float alpha = 1.0f);
     void setPos(int x, int y) { center_.x = x; center_.y = y; }
     void setTarget(const Character *t) { target_ = t; }
     void setOrbitDeg(float deg) { orbitDeg_ = deg; }
-    void checkCollision(Enemy &enemy);
+    void checkCollision(EnemySwarm &enemies, int i);
+    const SDL_Rect* getHitRect() const { return &dstRect_; }
 
 protected:
     SDL_Renderer *renderer_ = nullptr;
@@ -38,8 +44,10 @@ protected:
     int radiusSpeedPerSec_ = 20;
     float orbitDeg_ = 0; // 公转角度，向上为0度
     float spinDeg_ = 0;
+    float prevSpinDeg_ = 0;
     int frameIndex = 0;
     SDL_Rect dstRect_{0, 0, SIZE, SIZE};
+    SDL_Point prevPos_{0, 0}; // 上一步的 dstRect_ 位置，用于渲染插值
     SDL_Point center_{0, 0};
     const Character *target_ = nullptr; // 指向的target对象不能修改，但可以指向别的对象
 };
\ No newline at end of file
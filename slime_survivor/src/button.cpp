@@ -7,8 +7,12 @@ const char* Button::ATLAS_PATH = "../img/button.png";
 bool Button::init(SDL_Renderer *r, ButtonType type, int x, int y) {
     renderer_ = r;
     atlas_.texture = TextureCache::getInstance().get(r, ATLAS_PATH);
-    int startX = static_cast<int>(type) * SIZE * FRAME_NUM;
-    atlas_.atlasIndex = AtlasIndexCache::getInstance().get(atlas_.texture.get(), ATLAS_PATH, SIZE, SIZE, startX, 0, 1, FRAME_NUM);
+    // 每种按钮占一行中连续的 FRAME_NUM 帧
+    static constexpr const ClipDesc *CLIPS[] = {
+        &ClipGrid<SIZE, SIZE, 0, 0, 1, FRAME_NUM>::DESC,
+        &ClipGrid<SIZE, SIZE, SIZE * FRAME_NUM, 0, 1, FRAME_NUM>::DESC,
+    };
+    atlas_.atlasIndex = AtlasIndexCache::getInstance().get(atlas_.texture.get(), ATLAS_PATH, *CLIPS[static_cast<int>(type)]);
     dstRect_.x = x;
     dstRect_.y = y;
     dstRect_.w = SIZE;
@@ -51,5 +55,5 @@ void Button::handleMouseInput(const SDL_Event& e) {
 }
 
 void Button::render() {
-    SDL_RenderCopy(renderer_, atlas_.texture.get(), &atlas_.atlasIndex->frames[0][static_cast<int>(state_)], &dstRect_);
+    SDL_RenderCopy(renderer_, atlas_.texture.get(), &atlas_.atlasIndex->frame(0, static_cast<int>(state_)), &dstRect_);
 }
\ No newline at end of file
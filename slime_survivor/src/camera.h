@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+using namespace std;
+
+/**
+ * 跟随英雄的摄像机
+ * 视口是世界中屏幕大小的一块区域，中心对准目标并夹在世界范围内；世界坐标减去视口左上角即为屏幕坐标
+ */
+class Camera {
+public:
+    void setWorldSize(int w, int h) {
+        worldW_ = w;
+        worldH_ = h;
+    }
+
+    void setViewSize(int w, int h) {
+        view_.w = w;
+        view_.h = h;
+    }
+
+    /**
+     * 以 (cx, cy) 为中心的视口（世界坐标），不改变摄像机本身
+     */
+    SDL_Rect viewAt(float cx, float cy) const {
+        SDL_Rect v = view_;
+        v.x = max(0, min(int(cx) - v.w / 2, worldW_ - v.w));
+        v.y = max(0, min(int(cy) - v.h / 2, worldH_ - v.h));
+        return v;
+    }
+
+    void lookAt(float cx, float cy) { view_ = viewAt(cx, cy); }
+
+    const SDL_Rect &view() const { return view_; }
+
+    /**
+     * 世界坐标中的矩形是否与视口相交
+     */
+    bool visible(const SDL_Rect &r) const {
+        return r.x < view_.x + view_.w && r.x + r.w > view_.x && r.y < view_.y + view_.h && r.y + r.h > view_.y;
+    }
+
+    SDL_Rect toScreen(SDL_Rect r) const {
+        r.x -= view_.x;
+        r.y -= view_.y;
+        return r;
+    }
+
+private:
+    int worldW_ = 0, worldH_ = 0;
+    SDL_Rect view_{0, 0, 0, 0};
+};
@@ -14,43 +14,54 @@ const char* Hero::HURT_PATH = "../img/hero/hero_hurt.png";
 const char* Hero::ATTACK_PATH = "../img/hero/hero_attack.png";
 const char* Hero::DEATH_PATH = "../img/hero/hero_death.png";
 
-// Enemy类静态常量初始化
-const char* Enemy::WALK_PATH = "../img/enemy/enemy_walk.png";
-const char* Enemy::IDLE_PATH = "../img/enemy/enemy_idle.png";
-const char* Enemy::HURT_PATH = "../img/enemy/enemy_hurt.png";
-const char* Enemy::DEATH_PATH = "../img/enemy/enemy_death.png";
-const char* Enemy::ATTACK_PATH = "../img/enemy/enemy_attack.png";
-
 Character::~Character() {
     destroy();
 }
 
-SDL_Point Character::randomSpawnOutsidePos(int objW, int objH, int offset) {
+static mt19937 &spawnRng() {
     static mt19937 rng(random_device{}());
-    uniform_int_distribution<int> pickSize(0, 3);
-    const int side = pickSize(rng);
-    uniform_int_distribution<int> distX(0, max(0, SCREEN_WIDTH - 1));
-    uniform_int_distribution<int> distY(0, max(0, SCREEN_HEIGHT - 1));
+    return rng;
+}
+
+void Character::seedRandom(unsigned seed) {
+    spawnRng().seed(seed);
+}
+
+SDL_Point Character::randomSpawnOutsidePos(const SDL_Rect &view, int objW, int objH, int offset) {
+    mt19937 &rng = spawnRng();
+    // 只从外侧还有空间的边生成，否则会被夹回世界边缘、直接出现在视口里；四边都没有空间时退回到世界外
+    int sides[4], sideNum = 0;
+    if (view.x - objW - offset >= 0) sides[sideNum++] = 0;
+    if (view.x + view.w + offset + objW <= WORLD_WIDTH) sides[sideNum++] = 1;
+    if (view.y - objH - offset >= 0) sides[sideNum++] = 2;
+    if (view.y + view.h + offset + objH <= WORLD_HEIGHT) sides[sideNum++] = 3;
+    if (sideNum == 0) {
+        for (int s = 0; s < 4; ++s) sides[sideNum++] = s;
+    }
+    uniform_int_distribution<int> pickSide(0, sideNum - 1);
+    const int side = sides[pickSide(rng)];
+    uniform_int_distribution<int> distX(view.x, view.x + max(0, view.w - 1));
+    uniform_int_distribution<int> distY(view.y, view.y + max(0, view.h - 1));
     SDL_Point p{0, 0};
     switch (side) {
         case 0: { // 左侧
-            p.x = -objW - offset;
+            p.x = view.x - objW - offset;
             p.y = distY(rng);
             break;
         }
         case 1: { // 右侧
-            p.x = SCREEN_WIDTH + offset;
+            p.x = view.x + view.w + offset;
             p.y = distY(rng);
             break;
         }
         case 2: { // 顶部
             p.x = distX(rng);
-            p.y = -objH - offset;
+            p.y = view.y - objH - offset;
             break;
         }
         case 3: { // 底部
             p.x = distX(rng);
-            p.y = SCREEN_HEIGHT + offset;
+            p.y = view.y + view.h + offset;
             break;
         }
     }
@@ -67,22 +78,22 @@ bool Character::onInit(SDL_Renderer *r, int initX, int initY) {
     return true;
 }
 
-bool Character::addClip(AnimState state, const string &sheetPath, int frameW, int frameH, int rows, int cols, int fps, bool loop) {
+bool AnimArchetype::addClip(SDL_Renderer *r, AnimState state, const string &sheetPath, const ClipDesc &grid, int fps, bool loop) {
     try {
         AnimClip clip;
-        clip.texture = TextureCache::getInstance().get(renderer_, sheetPath);
+        clip.texture = TextureCache::getInstance().get(r, sheetPath);
         if (!clip.texture) {
             SDL_Log("Failed to get texture for path: %s", sheetPath.c_str());
             return false;
         }
-        clip.atlasIndex = AtlasIndexCache::getInstance().get(clip.texture.get(), sheetPath, frameW, frameH, 0, 0, rows, cols);
+        clip.atlasIndex = AtlasIndexCache::getInstance().get(clip.texture.get(), sheetPath, grid);
         if (!clip.atlasIndex) {
             SDL_Log("Failed to get anim set for path: %s", sheetPath.c_str());
             return false;
         }
         clip.fps = fps > 0 ? fps : 1;
         clip.loop = loop;
-        animClips_[state] = move(clip);
+        clips_[static_cast<int>(state)] = move(clip);
         return true;
     } catch (const exception &e) {
         SDL_Log("Error loading clip for path %s: %s", sheetPath.c_str(), e.what());
@@ -90,10 +101,10 @@ bool Character::addClip(AnimState state, const string &sheetPath, int frameW, in
     }
 }
 
-void Character::update(int dt_ms) {
-    auto it = animClips_.find(state_);
-    if (it == animClips_.end()) return;
-    const AnimClip &clip = it->second;
+void Character::update(float dt_ms) {
+    const AnimClip *clipPtr = currentClip();
+    if (!clipPtr) return;
+    const AnimClip &clip = *clipPtr;
     frameTimerMs_ += dt_ms;
     const float frameDur = 1000.0f / clip.fps;
     while (frameTimerMs_ >= frameDur) {
@@ -109,15 +120,17 @@ void Character::update(int dt_ms) {
     onUpdate(dt_ms);
 }
 
-void Character::onUpdate(int dt_ms) {}
+void Character::onUpdate(float dt_ms) {}
 
-void Character::render() {
-    auto it = animClips_.find(state_);
-    if (it == animClips_.end()) return;
-    const AnimClip &clip = it->second;
-    dstRect_.x = int(x_);
-    dstRect_.y = int(y_);
-    SDL_RenderCopy(renderer_, clip.texture.get(), &clip.atlasIndex->frames[static_cast<int>(dir_)][frameIdx_], &dstRect_);
+void Character::render(SpriteBatch &batch, const Camera &camera, float alpha) {
+    const AnimClip *clipPtr = currentClip();
+    if (!clipPtr) return;
+    const AnimClip &clip = *clipPtr;
+    SDL_Rect dst = dstRect_;
+    dst.x = int(prevX_ + (x_ - prevX_) * alpha);
+    dst.y = int(prevY_ + (y_ - prevY_) * alpha);
+    if (!camera.visible(dst)) return;
+    batch.draw(clip.texture.get(), clip.atlasIndex->frame(static_cast<int>(dir_), frameIdx_), camera.toScreen(dst));
     onRender();
 }
 
@@ -143,8 +156,10 @@ void Character::nextState() {
 }
 
 void Character::setPosition(double x, double y) {
-    x_ = x;
-    y_ = y;
+    x_ = prevX_ = x;
+    y_ = prevY_ = y;
+    dstRect_.x = int(x_);
+    dstRect_.y = int(y_);
 }
 
 void Character::moveBy(double dx, double dy) {
@@ -152,8 +167,11 @@ void Character::moveBy(double dx, double dy) {
     y_ += dy;
     if (x_ < 0) x_ = 0;
     if (y_ < 0) y_ = 0;
-    if (x_ + dstRect_.w > SCREEN_WIDTH) x_ = SCREEN_WIDTH - dstRect_.w;
-    if (y_ + dstRect_.h > SCREEN_HEIGHT) y_ = SCREEN_HEIGHT - dstRect_.h;
+    if (x_ + dstRect_.w > WORLD_WIDTH) x_ = WORLD_WIDTH - dstRect_.w;
+    if (y_ + dstRect_.h > WORLD_HEIGHT) y_ = WORLD_HEIGHT - dstRect_.h;
+    // 碰撞箱跟随模拟位置，而不是渲染时的插值位置
+    dstRect_.x = int(x_);
+    dstRect_.y = int(y_);
 }
 
 void Character::setDir(Dir d) {
@@ -173,16 +191,10 @@ void Character::setState(AnimState state) {
     frameIdx_ = 0;
     if (state == state_) return;
     state_ = state;
-    auto it = animClips_.find(state_);
-    if (it == animClips_.end()) return;
-    dstRect_.w = it->second.atlasIndex->frameW;
-    dstRect_.h = it->second.atlasIndex->frameH;
-}
-
-void Character::setStateFps(AnimState state, int fps) {
-    auto it = animClips_.find(state);
-    if (it == animClips_.end()) return;
-    it->second.fps = fps > 0 ? fps : 1;
+    const AnimClip *clip = currentClip();
+    if (!clip) return;
+    dstRect_.w = clip->atlasIndex->frameW;
+    dstRect_.h = clip->atlasIndex->frameH;
 }
 
 void Character::damage(int d) {
@@ -198,50 +210,41 @@ void Character::damage(int d) {
 
 bool Character::isAllOver() {
     if (state_ != AnimState::Death) return false;
-    auto it = animClips_.find(state_);
-    if (it == animClips_.end()) return false;
-    return frameIdx_ >= it->second.atlasIndex->cols - 1;
+    const AnimClip *clip = currentClip();
+    if (!clip) return false;
+    return frameIdx_ >= clip->atlasIndex->cols - 1;
 }
 
 void Character::destroy() {
-    for (auto &[st, clip] : animClips_) {
-        clip.texture.reset();
-        clip.atlasIndex.reset();
-    }
-    animClips_.clear();
+    archetype_.reset();
 }
 
-bool Hero::onInit(SDL_Renderer *r, int initX, int initY) {
-    setSize(SIZE, SIZE);
+shared_ptr<const AnimArchetype> Hero::archetype(SDL_Renderer *r) {
+    static weak_ptr<const AnimArchetype> cached;
+    if (auto sp = cached.lock()) return sp;
+    auto arch = make_shared<AnimArchetype>();
     // 添加所有动画状态
     bool success = true;
-    success &= addClip(AnimState::Idle, IDLE_PATH, SIZE, SIZE, 4, IDLE_NUM, DEFAULT_FPS, true);
-    success &= addClip(AnimState::Walk, WALK_PATH, SIZE, SIZE, 4, WALK_NUM, DEFAULT_FPS, true);
-    success &= addClip(AnimState::Hurt, HURT_PATH, SIZE, SIZE, 4, HURT_NUM, DEFAULT_FPS, false);
-    success &= addClip(AnimState::Attack, ATTACK_PATH, SIZE, SIZE, 4, ATTACK_NUM, DEFAULT_FPS, false);
-    success &= addClip(AnimState::Death, DEATH_PATH, SIZE, SIZE, 4, DEATH_NUM, DEFAULT_FPS, false);
+    success &= arch->addClip(r, AnimState::Idle, IDLE_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, IDLE_NUM>::DESC, DEFAULT_FPS, true);
+    success &= arch->addClip(r, AnimState::Walk, WALK_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, WALK_NUM>::DESC, DEFAULT_FPS, true);
+    success &= arch->addClip(r, AnimState::Hurt, HURT_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, HURT_NUM>::DESC, DEFAULT_FPS, false);
+    success &= arch->addClip(r, AnimState::Attack, ATTACK_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, ATTACK_NUM>::DESC, DEFAULT_FPS, false);
+    success &= arch->addClip(r, AnimState::Death, DEATH_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, DEATH_NUM>::DESC, DEFAULT_FPS, false);
     if (!success) {
         SDL_Log("Hero初始化动画失败");
+        return nullptr;
     }
-    return success;
+    cached = arch;
+    return arch;
 }
 
-bool Enemy::onInit(SDL_Renderer *r, int initX, int initY) {
+bool Hero::onInit(SDL_Renderer *r, int initX, int initY) {
     setSize(SIZE, SIZE);
-    // 添加所有动画状态
-    bool success = true;
-    success &= addClip(AnimState::Idle, IDLE_PATH, SIZE, SIZE, 4, IDLE_NUM, DEFAULT_FPS, true);
-    success &= addClip(AnimState::Walk, WALK_PATH, SIZE, SIZE, 4, WALK_NUM, DEFAULT_FPS, true);
-    success &= addClip(AnimState::Hurt, HURT_PATH, SIZE, SIZE, 4, HURT_NUM, DEFAULT_FPS * 2, false);
-    success &= addClip(AnimState::Attack, ATTACK_PATH, SIZE, SIZE, 4, ATTACK_NUM, DEFAULT_FPS, false);
-    success &= addClip(AnimState::Death, DEATH_PATH, SIZE, SIZE, 4, DEATH_NUM, DEFAULT_FPS, false);
-    if (!success) {
-        SDL_Log("Enemy初始化动画失败");
-    }
-    return success;
+    archetype_ = archetype(r);
+    return archetype_ != nullptr;
 }
 
-void Hero::handleInput(const Uint8 *keys, bool attackTriggered, int dt_ms) {
+void Hero::handleInput(const Uint8 *keys, bool attackTriggered, float dt_ms) {
     if (state_ == AnimState::Attack) return;
     if (attackTriggered) {
         attack();
@@ -263,29 +266,4 @@ void Hero::handleInput(const Uint8 *keys, bool attackTriggered, int dt_ms) {
     }
 }
 
-void Hero::onUpdate(int dt_ms) {}
-
-void Enemy::onUpdate(int dt_ms) {
-    if (!target_) return;
-    if (state_ == AnimState::Attack) return;
-    SDL_Point me = center();
-    SDL_Point th = target_ -> center();
-    double vx = th.x - me.x;
-    double vy = th.y - me.y;
-    double dist = sqrt(vx * vx + vy * vy);
-    if (dist <= ATTACK_RANGE) {
-        attack();
-    } else {
-        vx /= dist;
-        vy /= dist;
-        moveBy(vx * speed_ * dt_ms / 1000.0, vy * speed_ * dt_ms / 1000.0);
-        if (state_ == AnimState::Idle) setState(AnimState::Walk);
-    }
-}
-
-void Enemy::checkTargetCollision() {
-    if (!target_ || !damageable()) return;
-    if (SDL_HasIntersection(getHitRect(), target_->getHitRect())) {
-        target_->damage(10);
-    }
-}
\ No newline at end of file
+void Hero::onUpdate(float dt_ms) {}
@@ -1,12 +1,14 @@
 #pragma once
 #include <SDL2/SDL.h>
-#include <unordered_map>
 #include <memory>
+#include "camera.h"
 #include "constants.h"
 #include "resource_cache.h"
+#include "sprite_batch.h"
 using namespace std;
 
 enum class AnimState { Idle, Walk, Attack, Hurt, Death };
+static const int ANIM_STATE_NUM = 5;
 enum class Dir {Down = 0, Up = 1, Left = 2, Right = 3};
 struct AnimClip {
     shared_ptr<SDL_Texture> texture;
@@ -15,6 +17,29 @@ struct AnimClip {
     bool loop{true};
 };
 
+/**
+ * 动画原型（享元）：同一类角色共用的全部 clip，按 AnimState 下标存放
+ * 每类角色只构建一次，之后以 shared_ptr<const AnimArchetype> 共享，实例只持有指针
+ */
+class AnimArchetype {
+public:
+    /**
+     * 添加一个动画状态的 clip，仅在构建阶段调用
+     */
+    bool addClip(SDL_Renderer *r, AnimState state, const string &sheetPath, const ClipDesc &grid, int fps, bool loop);
+
+    /**
+     * 获取状态对应的 clip，未添加时返回 nullptr
+     */
+    const AnimClip *clip(AnimState state) const {
+        const AnimClip &c = clips_[static_cast<int>(state)];
+        return c.atlasIndex ? &c : nullptr;
+    }
+
+private:
+    AnimClip clips_[ANIM_STATE_NUM];
+};
+
 /**
  * 游戏中的角色基类
  */
@@ -25,7 +50,15 @@ public:
 
     virtual ~Character();
 
-    static SDL_Point randomSpawnOutsidePos(int objW = 0, int objH = 0, int offset = 0);
+    /**
+     * 在视口外一圈随机取一个出生点（世界坐标）；视口贴着世界边缘时不从那一侧生成
+     */
+    static SDL_Point randomSpawnOutsidePos(const SDL_Rect &view, int objW = 0, int objH = 0, int offset = 0);
+
+    /**
+     * 固定出生点随机数的种子，用于可复现的测试
+     */
+    static void seedRandom(unsigned seed);
 
     /**
      * 初始化
@@ -33,22 +66,22 @@ public:
     virtual bool init(SDL_Renderer *r, int initX, int initY);
 
     /**
-     * 更新状态，每帧调用（传入时间，以使帧率无关行为）
+     * 记录当前位置，作为渲染插值的起点，每个模拟步开始时调用
      */
-    virtual void update(int dt_ms);
+    void beginStep() { prevX_ = x_; prevY_ = y_; }
 
     /**
-     * 渲染，每帧调用
+     * 更新状态，每个模拟步调用（传入固定步长，以使帧率无关行为）
      */
-    virtual void render();
-
-    // 攻击
-    virtual void attack();
+    virtual void update(float dt_ms);
 
     /**
-     * 添加一个动画状态的 clip
+     * 渲染，每帧调用，alpha 为上一步到当前步之间的插值系数 [0, 1]；不在视口内时跳过
      */
-    bool addClip(AnimState state, const string &sheetPath, int frameW, int frameH, int rows, int cols, int fps, bool loop);
+    virtual void render(SpriteBatch &batch, const Camera &camera, float alpha = 1.0f);
+
+    // 攻击
+    virtual void attack();
 
     // 基础控制
     void setPosition(double x, double y);
@@ -56,7 +89,6 @@ public:
     void setDir(Dir d);
     void setSpeed(int s); // 每帧移动多少像素
     void setSize(int w, int h);
-    void setStateFps(AnimState state, int fps);
     // 获得碰撞箱
     virtual const SDL_Rect* getHitRect() const { return &dstRect_; }
 
@@ -66,6 +98,10 @@ public:
 
     // 获取角色中心坐标
     SDL_Point center() const { return {int(x_ + dstRect_.w / 2), int(y_ + dstRect_.h / 2)}; }
+    // 渲染插值后的中心坐标，供摄像机跟随
+    SDL_Point centerAt(float alpha) const {
+        return {int(prevX_ + (x_ - prevX_) * alpha + dstRect_.w / 2), int(prevY_ + (y_ - prevY_) * alpha + dstRect_.h / 2)};
+    }
 
     // 生命值
     int getHp() const { return hp; }
@@ -75,13 +111,14 @@ public:
 
 protected:
     SDL_Renderer *renderer_ = nullptr;
-    unordered_map<AnimState, AnimClip> animClips_;
+    shared_ptr<const AnimArchetype> archetype_;
 
     AnimState state_ = AnimState::Idle;
     Dir dir_ = Dir::Down;
     float frameTimerMs_ = 0.0f;
     int speed_ = 150; // 像素/秒
     double x_ = 0.0, y_ = 0.0;
+    double prevX_ = 0.0, prevY_ = 0.0;
     int frameIdx_ = 0;
     int tickCnt_  = 0;
     SDL_Rect dstRect_{ 0, 0, 64, 64 };
@@ -91,9 +128,10 @@ protected:
 
     void destroy();
     void nextState();
+    const AnimClip *currentClip() const { return archetype_ ? archetype_->clip(state_) : nullptr; }
 
     virtual bool onInit(SDL_Renderer *r, int initX, int initY);
-    virtual void onUpdate(int dt_ms);
+    virtual void onUpdate(float dt_ms);
     virtual void onRender();
     virtual void onAttack();
 };
@@ -119,39 +157,12 @@ public:
     static const char* ATTACK_PATH;
     static const char* DEATH_PATH;
     
-    bool onInit(SDL_Renderer *r, int initX, int initY) override;
-    void handleInput(const Uint8 *keys, bool attackTriggered, int dt_ms);
-    void onUpdate(int dt_ms) override;
-};
+    /**
+     * 获取所有Hero共用的动画原型，首次调用时构建
+     */
+    static shared_ptr<const AnimArchetype> archetype(SDL_Renderer *r);
 
-/**
- * 敌人角色
- */
-class Enemy final : public Character {
-public:
-    // 角色相关常量
-    static const int WALK_NUM = 8;
-    static const int IDLE_NUM = 6;
-    static const int HURT_NUM = 5;
-    static const int DEATH_NUM = 10;
-    static const int ATTACK_NUM = 10;
-    static const int SIZE = 64;
-    static const int DEFAULT_FPS = 10;
-    static const int ATTACK_RANGE = 10;
-    
-    // 图片路径常量
-    static const char* WALK_PATH;
-    static const char* IDLE_PATH;
-    static const char* HURT_PATH;
-    static const char* DEATH_PATH;
-    static const char* ATTACK_PATH;
-    
     bool onInit(SDL_Renderer *r, int initX, int initY) override;
-    void onUpdate(int dt_ms) override;
-    void setTarget(Character *t) { target_ = t; }
-    void checkTargetCollision();
-protected:
-    bool damageable() { return state_ == AnimState::Attack && frameIdx_ >= 7; }
-private:
-    Character *target_ = nullptr;
+    void handleInput(const Uint8 *keys, bool attackTriggered, float dt_ms);
+    void onUpdate(float dt_ms) override;
 };
@@ -2,4 +2,12 @@
 
 // 屏幕尺寸常量定义
 const int SCREEN_WIDTH = 960;
-const int SCREEN_HEIGHT = 640;
\ No newline at end of file
+const int SCREEN_HEIGHT = 640;
+
+// 世界尺寸常量定义（每边 4 屏）
+const int WORLD_WIDTH = 3840;
+const int WORLD_HEIGHT = 2560;
+
+// 固定步长模拟常量定义（120Hz）
+const float SIM_STEP_MS = 1000.0f / 120;
+const int MAX_SIM_STEPS_PER_FRAME = 8;
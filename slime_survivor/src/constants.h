@@ -2,4 +2,12 @@
 
 // 屏幕尺寸常量
 extern const int SCREEN_WIDTH;
-extern const int SCREEN_HEIGHT;
\ No newline at end of file
+extern const int SCREEN_HEIGHT;
+
+// 世界尺寸常量：地图比屏幕大，摄像机跟随英雄只显示其中一块
+extern const int WORLD_WIDTH;
+extern const int WORLD_HEIGHT;
+
+// 固定步长模拟：每步时长（毫秒）和每帧最多追赶的步数
+extern const float SIM_STEP_MS;
+extern const int MAX_SIM_STEPS_PER_FRAME;
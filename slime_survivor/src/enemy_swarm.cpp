@@ -0,0 +1,331 @@
+#include "enemy_swarm.h"
+#include <algorithm>
+#include "audio_manager.h"
+#include "constants.h"
+#include "profiler.h"
+
+const char* EnemySwarm::WALK_PATH = "../img/enemy/enemy_walk.png";
+const char* EnemySwarm::IDLE_PATH = "../img/enemy/enemy_idle.png";
+const char* EnemySwarm::HURT_PATH = "../img/enemy/enemy_hurt.png";
+const char* EnemySwarm::DEATH_PATH = "../img/enemy/enemy_death.png";
+const char* EnemySwarm::ATTACK_PATH = "../img/enemy/enemy_attack.png";
+
+shared_ptr<const AnimArchetype> EnemySwarm::archetype(SDL_Renderer *r) {
+    static weak_ptr<const AnimArchetype> cached;
+    if (auto sp = cached.lock()) return sp;
+    auto arch = make_shared<AnimArchetype>();
+    bool success = true;
+    success &= arch->addClip(r, AnimState::Idle, IDLE_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, IDLE_NUM>::DESC, DEFAULT_FPS, true);
+    success &= arch->addClip(r, AnimState::Walk, WALK_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, WALK_NUM>::DESC, DEFAULT_FPS, true);
+    success &= arch->addClip(r, AnimState::Hurt, HURT_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, HURT_NUM>::DESC, DEFAULT_FPS * 2, false);
+    success &= arch->addClip(r, AnimState::Attack, ATTACK_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, ATTACK_NUM>::DESC, DEFAULT_FPS, false);
+    success &= arch->addClip(r, AnimState::Death, DEATH_PATH, ClipGrid<SIZE, SIZE, 0, 0, 4, DEATH_NUM>::DESC, DEFAULT_FPS, false);
+    if (!success) {
+        SDL_Log("Enemy初始化动画失败");
+        return nullptr;
+    }
+    cached = arch;
+    return arch;
+}
+
+bool EnemySwarm::init(SDL_Renderer *r, int capacity) {
+    renderer_ = r;
+    archetype_ = archetype(r);
+    if (!archetype_) return false;
+    capacity_ = capacity > 0 ? capacity : DEFAULT_CAPACITY;
+    count_ = 0;
+    x_.assign(capacity_, 0); y_.assign(capacity_, 0);
+    prevX_.assign(capacity_, 0); prevY_.assign(capacity_, 0);
+    vx_.assign(capacity_, 0); vy_.assign(capacity_, 0);
+    hp_.assign(capacity_, 0);
+    state_.assign(capacity_, AnimState::Idle);
+    dir_.assign(capacity_, Dir::Down);
+    frameIdx_.assign(capacity_, 0);
+    frameTimerMs_.assign(capacity_, 0);
+    lodShift_.assign(capacity_, 0);
+    lastStep_.assign(capacity_, 0);
+    denseSlot_.assign(capacity_, -1);
+    slotDense_.assign(capacity_, -1);
+    slotGeneration_.assign(capacity_, 0);
+    // 空闲栈倒序放入，保证先用小号槽位
+    freeSlots_.resize(capacity_);
+    for (int s = 0; s < capacity_; ++s) {
+        freeSlots_[s] = capacity_ - 1 - s;
+    }
+    freeTop_ = capacity_;
+    chunks_.assign((capacity_ + UPDATE_CHUNK - 1) / UPDATE_CHUNK, ChunkScratch());
+    for (auto &c : chunks_) {
+        c.hits.reserve(UPDATE_CHUNK);
+        c.due.resize(UPDATE_CHUNK);
+        c.x.resize(UPDATE_CHUNK); c.y.resize(UPDATE_CHUNK);
+        c.vx.resize(UPDATE_CHUNK); c.vy.resize(UPDATE_CHUNK);
+        c.flowX.resize(UPDATE_CHUNK); c.flowY.resize(UPDATE_CHUNK);
+        c.moving.resize(UPDATE_CHUNK); c.arrived.resize(UPDATE_CHUNK);
+    }
+    step_ = 0;
+    setLod(lod_);
+    return true;
+}
+
+void EnemySwarm::setLod(const SwarmLod &lod) {
+    lod_ = lod;
+    lod_.maxShift = max(0, min(lod_.maxShift, (int)MAX_LOD_SHIFT));
+    lod_.midShift = max(0, min(lod_.midShift, lod_.maxShift));
+    lod_.farShift = max(lod_.midShift, min(lod_.farShift, lod_.maxShift));
+    lodStats_ = SwarmLodStats();
+    lastAdjust_ = step_;
+    midShift_ = lod_.enabled ? lod_.midShift : 0;
+    farShift_ = lod_.enabled ? lod_.farShift : 0;
+}
+
+EnemyHandle EnemySwarm::spawn(float x, float y) {
+    if (freeTop_ == 0) return {};
+    const int slot = freeSlots_[--freeTop_];
+    const int i = count_++;
+    x_[i] = x; y_[i] = y;
+    prevX_[i] = x; prevY_[i] = y;
+    vx_[i] = 0; vy_[i] = 0;
+    hp_[i] = DEFAULT_HP;
+    state_[i] = AnimState::Idle;
+    dir_[i] = Dir::Down;
+    frameIdx_[i] = 0;
+    frameTimerMs_[i] = 0;
+    lodShift_[i] = 0; // 下一步就轮到，届时按距离分级
+    lastStep_[i] = step_ - 1;
+    denseSlot_[i] = slot;
+    slotDense_[slot] = i;
+    return {slot, slotGeneration_[slot]};
+}
+
+void EnemySwarm::release(int i) {
+    const int last = count_ - 1;
+    if (i < 0 || i > last) return;
+    const int slot = denseSlot_[i];
+    slotGeneration_[slot]++;
+    slotDense_[slot] = -1;
+    freeSlots_[freeTop_++] = slot;
+    if (i != last) {
+        x_[i] = x_[last]; y_[i] = y_[last];
+        prevX_[i] = prevX_[last]; prevY_[i] = prevY_[last];
+        vx_[i] = vx_[last]; vy_[i] = vy_[last];
+        hp_[i] = hp_[last];
+        state_[i] = state_[last];
+        dir_[i] = dir_[last];
+        frameIdx_[i] = frameIdx_[last];
+        frameTimerMs_[i] = frameTimerMs_[last];
+        lodShift_[i] = lodShift_[last];
+        lastStep_[i] = lastStep_[last];
+        denseSlot_[i] = denseSlot_[last];
+        slotDense_[denseSlot_[i]] = i;
+    }
+    count_ = last;
+}
+
+int EnemySwarm::indexOf(EnemyHandle h) const {
+    if (h.slot < 0 || h.slot >= capacity_) return -1;
+    if (slotGeneration_[h.slot] != h.generation) return -1;
+    return slotDense_[h.slot];
+}
+
+void EnemySwarm::setState(int i, AnimState s) {
+    frameIdx_[i] = 0;
+    state_[i] = s;
+    // 攻击和死亡时停下，LOD 轮空的步上也不再沿旧速度移动
+    if (s == AnimState::Attack || s == AnimState::Death) {
+        vx_[i] = vy_[i] = 0;
+    }
+}
+
+void EnemySwarm::beginStep() {
+    // 只拷贝有效部分，数组长度固定不会重新分配
+    copy_n(x_.begin(), count_, prevX_.begin());
+    copy_n(y_.begin(), count_, prevY_.begin());
+}
+
+void EnemySwarm::update(float dt_ms, WorkerPool *pool) {
+    PROFILE_ZONE("enemies");
+    const Uint64 start = lod_.budgetUs > 0 ? SDL_GetPerformanceCounter() : 0;
+    const int n = size();
+    const int chunks = (n + UPDATE_CHUNK - 1) / UPDATE_CHUNK;
+    // 目标在本阶段只读，先在调用线程上取好位置
+    const SDL_Point targetCenter = target_ ? target_->center() : SDL_Point{0, 0};
+    const SDL_Rect targetRect = target_ ? *target_->getHitRect() : SDL_Rect{0, 0, 0, 0};
+    auto job = [&](int chunk) {
+        PROFILE_ZONE("enemies.chunk");
+        const int begin = chunk * UPDATE_CHUNK;
+        updateRange(begin, min(n, begin + UPDATE_CHUNK), dt_ms, targetCenter, targetRect, chunks_[chunk]);
+    };
+    if (pool) {
+        pool->parallelFor(chunks, job);
+    } else {
+        for (int c = 0; c < chunks; ++c) job(c);
+    }
+    // 合并：按块顺序（即下标顺序）结算对目标的伤害，伤害和音效都只在调用线程上发生
+    lodStats_.steered = 0;
+    for (int c = 0; c < chunks; ++c) {
+        for (size_t k = 0; k < chunks_[c].hits.size(); ++k) {
+            target_->damage(10);
+        }
+        lodStats_.steered += chunks_[c].steered;
+    }
+    step_++;
+    if (lod_.budgetUs > 0) adjustLod(SDL_GetPerformanceCounter() - start);
+}
+
+void EnemySwarm::adjustLod(Uint64 ticks) {
+    const double us = ticks * 1000000.0 / SDL_GetPerformanceFrequency();
+    lodStats_.updateUs = lodStats_.updateUs > 0 ? lodStats_.updateUs * 0.9 + us * 0.1 : us;
+    if (!lod_.enabled) return;
+    // 间隔改变后要等每个敌人都轮到一次才能反映在耗时上，这之前不再调整
+    if (step_ - lastAdjust_ < (1u << lod_.maxShift) * 2) return;
+    int extra = lodStats_.extraShift;
+    if (lodStats_.updateUs > lod_.budgetUs && lod_.midShift + extra < lod_.maxShift) {
+        extra++;
+    } else if (lodStats_.updateUs < lod_.budgetUs / 2 && extra > 0) {
+        extra--; // 留一半余量，避免在预算附近来回调整
+    } else {
+        return;
+    }
+    lodStats_.extraShift = extra;
+    lastAdjust_ = step_;
+    midShift_ = min(lod_.midShift + extra, lod_.maxShift);
+    farShift_ = min(lod_.farShift + extra, lod_.maxShift);
+}
+
+void EnemySwarm::advanceAnim(int i, const AnimClip &clip) {
+    const float frameDur = 1000.0f / clip.fps;
+    if (frameTimerMs_[i] < frameDur) return;
+    // 轮空期间累加的时间可能跨过多帧，一次算出要推进的帧数
+    const int frames = int(frameTimerMs_[i] / frameDur);
+    frameTimerMs_[i] -= frames * frameDur;
+    const int cols = clip.atlasIndex->cols;
+    if (clip.loop) {
+        frameIdx_[i] = (frameIdx_[i] + frames) % cols;
+    } else if (frameIdx_[i] + frames < cols) {
+        frameIdx_[i] += frames;
+    } else if (state_[i] == AnimState::Hurt || state_[i] == AnimState::Attack) {
+        setState(i, AnimState::Idle);
+    } else {
+        frameIdx_[i] = cols - 1;
+    }
+}
+
+void EnemySwarm::updateRange(int begin, int end, float dt_ms, SDL_Point targetCenter, SDL_Rect targetRect, ChunkScratch &s) {
+    s.hits.clear();
+    const SDL_Rect view = animView_;
+    const Uint32 step = step_;
+    const float maxX = WORLD_WIDTH - SIZE, maxY = WORLD_HEIGHT - SIZE;
+    // 收集轮到本步的敌人：只读两个数组、无分支追加（轮到与否按槽位交错，分支难以预测）
+    int due = 0;
+    for (int i = begin; i < end; ++i) {
+        s.due[due] = i;
+        due += ((step + denseSlot_[i]) & ((1u << lodShift_[i]) - 1)) == 0;
+    }
+    s.steered = due;
+    // 轮到的敌人补上轮空期间的动画时间并推进动画，记下本步起点后交给追踪内核
+    for (int k = 0; k < due; ++k) {
+        const int i = s.due[k];
+        const AnimClip &clip = clipOf(state_[i]);
+        // 视口外的循环动画只影响外观，不推进
+        if (!clip.loop || inView(i, view)) {
+            frameTimerMs_[i] += (step - lastStep_[i]) * dt_ms;
+            advanceAnim(i, clip);
+        }
+        lastStep_[i] = step;
+        s.x[k] = x_[i]; s.y[k] = y_[i];
+        s.moving[k] = state_[i] != AnimState::Attack && state_[i] != AnimState::Death;
+    }
+    // 所有敌人先沿上次的速度移动（与追踪内核的位移和夹紧方式一致），轮到的敌人随后被内核的结果覆盖
+    // 攻击和死亡时速度已清零；整段是无分支的浮点循环，可以向量化
+    for (int i = begin; i < end; ++i) {
+        x_[i] = min(max(x_[i] + vx_[i] * dt_ms / 1000.0f, 0.0f), maxX);
+        y_[i] = min(max(y_[i] + vy_[i] * dt_ms / 1000.0f, 0.0f), maxY);
+    }
+    if (!target_) return;
+    // 按与目标的距离重新分级，决定下次轮到的间隔
+    const float nearSq = lod_.nearDist * lod_.nearDist, farSq = lod_.farDist * lod_.farDist;
+    const bool lodOn = lod_.enabled;
+    for (int k = 0; k < due; ++k) {
+        const float dx = s.x[k] + SIZE / 2 - targetCenter.x, dy = s.y[k] + SIZE / 2 - targetCenter.y;
+        const float d2 = dx * dx + dy * dy;
+        lodShift_[s.due[k]] = !lodOn || d2 <= nearSq ? 0 : uint8_t(d2 <= farSq ? midShift_ : farShift_);
+    }
+    // 追踪目标：方向、位移和夹紧由向量化内核对收集起来的敌人批量计算
+    SeekParams p;
+    p.targetX = targetCenter.x;
+    p.targetY = targetCenter.y;
+    p.halfSize = SIZE / 2;
+    p.speed = speed_;
+    p.dt_ms = dt_ms;
+    p.attackRange = ATTACK_RANGE;
+    p.maxX = maxX;
+    p.maxY = maxY;
+    // 按敌人中心所在格子查流场方向，每个敌人 O(1)
+    const float *flowX = nullptr, *flowY = nullptr;
+    if (flowField_) {
+        for (int k = 0; k < due; ++k) {
+            const int cell = flowField_->cellAt(s.x[k] + SIZE / 2, s.y[k] + SIZE / 2);
+            s.flowX[k] = cell >= 0 ? flowField_->dirX(cell) : 0;
+            s.flowY[k] = cell >= 0 ? flowField_->dirY(cell) : 0;
+        }
+        flowX = s.flowX.data();
+        flowY = s.flowY.data();
+    }
+    bestSeekKernel().fn(p, s.x.data(), s.y.data(), s.vx.data(), s.vy.data(), flowX, flowY,
+                        s.moving.data(), s.arrived.data(), due);
+    for (int k = 0; k < due; ++k) {
+        const int i = s.due[k];
+        x_[i] = s.x[k]; y_[i] = s.y[k];
+        vx_[i] = s.vx[k]; vy_[i] = s.vy[k];
+        if (s.arrived[k]) {
+            setState(i, AnimState::Attack);
+        } else if (s.moving[k] && state_[i] == AnimState::Idle) {
+            setState(i, AnimState::Walk);
+        }
+    }
+    // 攻击判定：只记录，不直接修改目标；能攻击的敌人都在近处，每步都轮到
+    for (int k = 0; k < due; ++k) {
+        const int i = s.due[k];
+        if (!damageable(i)) continue;
+        const SDL_Rect rect = getHitRect(i);
+        if (SDL_HasIntersection(&rect, &targetRect)) {
+            s.hits.push_back(i);
+        }
+    }
+}
+
+int EnemySwarm::render(SpriteBatch &batch, const Camera &camera, float alpha) {
+    const int n = size();
+    const SDL_Rect &view = camera.view();
+    const float left = float(view.x - SIZE), top = float(view.y - SIZE);
+    const float right = float(view.x + view.w), bottom = float(view.y + view.h);
+    SDL_Rect dst{0, 0, SIZE, SIZE};
+    int drawn = 0;
+    for (int i = 0; i < n; ++i) {
+        const float x = prevX_[i] + (x_[i] - prevX_[i]) * alpha;
+        const float y = prevY_[i] + (y_[i] - prevY_[i]) * alpha;
+        if (x <= left || x >= right || y <= top || y >= bottom) continue;
+        const AnimClip &clip = clipOf(state_[i]);
+        dst.x = int(x) - view.x;
+        dst.y = int(y) - view.y;
+        batch.draw(clip.texture.get(), clip.atlasIndex->frame(static_cast<int>(dir_[i]), frameIdx_[i]), dst);
+        drawn++;
+    }
+    return drawn;
+}
+
+void EnemySwarm::damage(int i, int d) {
+    if (state_[i] == AnimState::Hurt || state_[i] == AnimState::Death) return;
+    hp_[i] -= d;
+    if (hp_[i] <= 0) {
+        setState(i, AnimState::Death);
+    } else {
+        setState(i, AnimState::Hurt);
+        AudioManager::getInstance().playHurt(0.5f);
+    }
+}
+
+bool EnemySwarm::isAllOver(int i) const {
+    if (state_[i] != AnimState::Death) return false;
+    return frameIdx_[i] >= clipOf(AnimState::Death).atlasIndex->cols - 1;
+}
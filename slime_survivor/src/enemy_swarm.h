@@ -0,0 +1,205 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <climits>
+#include <vector>
+#include "character.h"
+#include "worker_pool.h"
+#include "steering.h"
+#include "flow_field.h"
+using namespace std;
+
+/**
+ * 敌人句柄：槽位号 + 代数
+ * 槽位被回收再利用时代数加一，旧句柄随之失效，不会误指向新生成的敌人
+ */
+struct EnemyHandle {
+    int slot = -1;
+    Uint32 generation = 0;
+
+    bool valid() const { return slot >= 0; }
+};
+
+/**
+ * 敌人的细节层次（LOD）：离目标越远，重新追踪（查流场、算方向）的间隔越长
+ * 间隔为 2 的幂，同一间隔的敌人按槽位错开到不同的步上，每步的开销保持均匀；
+ * 轮空的步上敌人只沿上次的速度继续移动，动画等轮到时按间隔的步数一次推进若干帧（模拟步长固定）
+ */
+struct SwarmLod {
+    bool enabled = true;
+    float nearDist = 480; // 距目标不超过它的敌人每步都更新，攻击判定只会发生在这个范围内
+    float farDist = 960;  // 超过它的敌人按 farShift 更新，两者之间按 midShift
+    int midShift = 1;     // 中距离每 2^midShift 步更新一次
+    int farShift = 2;     // 远处每 2^farShift 步更新一次
+    int maxShift = 4;     // 预算调整时间隔的上限，最多 2^maxShift 步
+    int budgetUs = 0;     // 每步更新的时间预算（微秒）：超出时拉长中、远距离的间隔，0 表示固定间隔
+};
+
+/**
+ * LOD 的运行情况
+ */
+struct SwarmLodStats {
+    double updateUs = 0; // 平滑后的每步更新耗时，只在设置了预算时统计
+    int steered = 0;     // 上一步重新追踪的敌人数
+    int extraShift = 0;  // 预算调整额外加在中、远距离间隔上的位移
+};
+
+/**
+ * 敌人群体
+ * 所有史莱姆的状态按结构数组（SoA）连续存放，更新和渲染都是紧凑循环，不走虚函数
+ * 内部是固定容量的对象池：数组在 init 时一次分配好，生成/回收只改计数和空闲槽位栈，不再触发堆分配
+ * 活着的敌人始终紧密排在 [0, size()) 中；下标在回收时可能变化，需要长期持有时用 EnemyHandle
+ */
+class EnemySwarm {
+public:
+    // 角色相关常量
+    static const int WALK_NUM = 8;
+    static const int IDLE_NUM = 6;
+    static const int HURT_NUM = 5;
+    static const int DEATH_NUM = 10;
+    static const int ATTACK_NUM = 10;
+    static const int SIZE = 64;
+    static const int DEFAULT_FPS = 10;
+    static const int ATTACK_RANGE = 10;
+    static const int DEFAULT_HP = 100;
+    static const int DEFAULT_CAPACITY = 1024;
+    static const int UPDATE_CHUNK = 1024; // 并行更新时每块的敌人数
+    static const int MAX_LOD_SHIFT = 6;
+
+    // 图片路径常量
+    static const char* WALK_PATH;
+    static const char* IDLE_PATH;
+    static const char* HURT_PATH;
+    static const char* DEATH_PATH;
+    static const char* ATTACK_PATH;
+
+    /**
+     * 获取所有敌人共用的动画原型，首次调用时构建
+     */
+    static shared_ptr<const AnimArchetype> archetype(SDL_Renderer *r);
+
+    /**
+     * 初始化，加载所有敌人共用的动画，并按容量预分配对象池
+     */
+    bool init(SDL_Renderer *r, int capacity = DEFAULT_CAPACITY);
+
+    /**
+     * 在指定位置生成一个敌人，池已满时返回无效句柄
+     */
+    EnemyHandle spawn(float x, float y);
+
+    /**
+     * 回收下标为i的敌人（末尾敌人搬到i，槽位放回空闲栈并使旧句柄失效）
+     */
+    void release(int i);
+
+    /**
+     * 句柄对应的当前下标，句柄已失效时返回 -1
+     */
+    int indexOf(EnemyHandle h) const;
+
+    EnemyHandle handleOf(int i) const { return {denseSlot_[i], slotGeneration_[denseSlot_[i]]}; }
+
+    /**
+     * 记录所有敌人的当前位置，作为渲染插值的起点，每个模拟步开始时调用
+     */
+    void beginStep();
+
+    /**
+     * 更新所有敌人的动画、移动和对目标的攻击，每个模拟步调用
+     * 传入线程池时按块并行更新；对目标造成的伤害先按块记录，全部完成后在调用线程上按下标顺序结算，
+     * 因此结果与线程数无关
+     * 离目标远的敌人按 LOD 间隔隔几步才重新追踪一次，见 SwarmLod
+     */
+    void update(float dt_ms, WorkerPool *pool = nullptr);
+
+    /**
+     * 渲染视口内的敌人，每帧调用，alpha 为上一步到当前步之间的插值系数 [0, 1]
+     * 视口外的敌人只做一次位置比较，不提交精灵，返回实际提交的数量
+     */
+    int render(SpriteBatch &batch, const Camera &camera, float alpha = 1.0f);
+
+    /**
+     * 设置动画视口（世界坐标）：视口外敌人的循环动画（待机、行走）不推进，默认不限制
+     * 非循环动画决定攻击判定、受击恢复和死亡回收，无论是否可见都照常推进
+     */
+    void setAnimView(const SDL_Rect &view) { animView_ = view; }
+
+    void setTarget(Character *t) { target_ = t; }
+    /**
+     * 设置流场后敌人按流场方向绕开障碍，靠近目标时再直接追踪；流场由调用方在 update 前按目标位置更新
+     */
+    void setFlowField(const FlowField *f) { flowField_ = f; }
+    void setSpeed(int s) { speed_ = s; }
+    /**
+     * 设置 LOD 参数；设置了预算时间隔随实际耗时调整，结果与机器快慢有关，需要复现时预算设为 0
+     */
+    void setLod(const SwarmLod &lod);
+    const SwarmLod &lod() const { return lod_; }
+    const SwarmLodStats &lodStats() const { return lodStats_; }
+
+    int size() const { return count_; }
+    int capacity() const { return capacity_; }
+    bool full() const { return count_ >= capacity_; }
+    SDL_Rect getHitRect(int i) const { return {int(x_[i]), int(y_[i]), SIZE, SIZE}; }
+    AnimState getState(int i) const { return state_[i]; }
+    int getHp(int i) const { return hp_[i]; }
+
+    void damage(int i, int d);
+    bool isAllOver(int i) const;
+
+private:
+    SDL_Renderer *renderer_ = nullptr;
+    shared_ptr<const AnimArchetype> archetype_;
+    Character *target_ = nullptr;
+    const FlowField *flowField_ = nullptr;
+    int speed_ = 60; // 像素/秒
+    SDL_Rect animView_{INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX};
+    SwarmLod lod_;
+    SwarmLodStats lodStats_;
+    Uint32 step_ = 0;       // 已更新的步数，与槽位号一起决定敌人轮到哪一步
+    Uint32 lastAdjust_ = 0; // 上次按预算调整间隔的步数
+    int midShift_ = 1, farShift_ = 2; // 本步使用的间隔位移（已含预算调整）
+
+    int count_ = 0;
+    int capacity_ = 0;
+
+    // 每个敌人一个元素的并行数组，长度固定为 capacity_，只有前 count_ 个有效
+    vector<float> x_, y_;
+    vector<float> prevX_, prevY_; // 上一步的位置，用于渲染插值
+    vector<float> vx_, vy_; // 像素/秒
+    vector<int> hp_;
+    vector<AnimState> state_;
+    vector<Dir> dir_;
+    vector<int> frameIdx_;
+    vector<float> frameTimerMs_;
+    vector<uint8_t> lodShift_; // 每 2^lodShift_ 步重新追踪一次，轮到时按距离重新分级
+    vector<Uint32> lastStep_;  // 上次轮到的步数，轮到时按间隔的步数补上动画时间
+
+    // 槽位表：句柄的槽位号 <-> 数组下标，以及空闲槽位栈
+    vector<int> denseSlot_;        // 下标 -> 槽位
+    vector<int> slotDense_;        // 槽位 -> 下标
+    vector<Uint32> slotGeneration_;
+    vector<int> freeSlots_;
+    int freeTop_ = 0;
+
+    // 每块一份的临时数组，容量在 init 时预留，更新时不再分配
+    struct ChunkScratch {
+        vector<int> hits;  // 本步攻击命中目标的敌人下标
+        vector<int> due;   // 本步轮到重新追踪的敌人下标
+        int steered = 0;
+        // 按 due 收集的紧凑数组，作为追踪内核的输入/输出
+        vector<float> x, y, vx, vy, flowX, flowY;
+        vector<uint8_t> moving, arrived;
+    };
+    vector<ChunkScratch> chunks_;
+
+    const AnimClip &clipOf(AnimState s) const { return *archetype_->clip(s); }
+    void setState(int i, AnimState s);
+    void updateRange(int begin, int end, float dt_ms, SDL_Point targetCenter, SDL_Rect targetRect, ChunkScratch &s);
+    void advanceAnim(int i, const AnimClip &clip);
+    void adjustLod(Uint64 ticks);
+    bool inView(int i, const SDL_Rect &v) const {
+        return x_[i] < v.x + v.w && x_[i] + SIZE > v.x && y_[i] < v.y + v.h && y_[i] + SIZE > v.y;
+    }
+    bool damageable(int i) const { return state_[i] == AnimState::Attack && frameIdx_[i] >= 7; }
+};
@@ -0,0 +1,128 @@
+#include "flow_field.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <functional>
+
+// 8 个方向：先 4 个直走，再 4 个斜走
+static const int NEIGHBOR_DX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int NEIGHBOR_DY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+static const int STRAIGHT_COST = 10;
+static const int DIAGONAL_COST = 14;
+static const float DIAGONAL_UNIT = 0.70710678f;
+
+void FlowField::init(int worldW, int worldH, int cellSize) {
+    cellShift_ = 0;
+    while ((1 << cellShift_) < cellSize) cellShift_++;
+    cols_ = (worldW + cellSize - 1) >> cellShift_;
+    rows_ = (worldH + cellSize - 1) >> cellShift_;
+    const int cells = cols_ * rows_;
+    blocked_.assign(cells, 0);
+    dist_.assign(cells, UNREACHABLE);
+    dirX_.assign(cells, 0);
+    dirY_.assign(cells, 0);
+    heap_.clear();
+    heap_.reserve(cells * 8);
+    goalCell_ = -1;
+    dirty_ = true;
+}
+
+bool FlowField::loadBlocked(const char *path) {
+    SDL_Surface *raw = IMG_Load(path);
+    if (!raw) {
+        SDL_Log("未找到碰撞层 %s，全部格子视为可通行", path);
+        return false;
+    }
+    SDL_Surface *surface = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(raw);
+    if (!surface) {
+        SDL_Log("SDL Convert Surface Error: %s", SDL_GetError());
+        return false;
+    }
+    SDL_LockSurface(surface);
+    const Uint8 *pixels = static_cast<const Uint8 *>(surface->pixels);
+    for (int cy = 0; cy < rows_; ++cy) {
+        const int py = min(surface->h - 1, (cy * 2 + 1) * surface->h / (rows_ * 2));
+        for (int cx = 0; cx < cols_; ++cx) {
+            const int px = min(surface->w - 1, (cx * 2 + 1) * surface->w / (cols_ * 2));
+            // RGBA32 在内存中按 R G B A 排列，第 4 个字节是 alpha
+            blocked_[cy * cols_ + cx] = pixels[py * surface->pitch + px * 4 + 3] >= 128;
+        }
+    }
+    SDL_UnlockSurface(surface);
+    SDL_FreeSurface(surface);
+    dirty_ = true;
+    return true;
+}
+
+void FlowField::setBlocked(int cx, int cy, bool blocked) {
+    if (cx < 0 || cy < 0 || cx >= cols_ || cy >= rows_) return;
+    blocked_[cy * cols_ + cx] = blocked;
+    dirty_ = true;
+}
+
+bool FlowField::setGoal(int x, int y) {
+    // 目标在网格外时按最近的边缘格子计算
+    const int cx = max(0, min(cols_ - 1, x >> cellShift_));
+    const int cy = max(0, min(rows_ - 1, y >> cellShift_));
+    const int cell = cy * cols_ + cx;
+    if (cell == goalCell_ && !dirty_) return false;
+    goalCell_ = cell;
+    rebuild();
+    return true;
+}
+
+void FlowField::rebuild() {
+    dirty_ = false;
+    rebuilds_++;
+    fill(dist_.begin(), dist_.end(), UNREACHABLE);
+    // Dijkstra：小顶堆按距离弹出
+    auto cmp = greater<pair<int, int>>();
+    heap_.clear();
+    dist_[goalCell_] = 0;
+    heap_.push_back({0, goalCell_});
+    while (!heap_.empty()) {
+        pop_heap(heap_.begin(), heap_.end(), cmp);
+        const pair<int, int> top = heap_.back();
+        heap_.pop_back();
+        const int d = top.first, cell = top.second;
+        if (d > dist_[cell]) continue;
+        const int cx = cell % cols_, cy = cell / cols_;
+        for (int k = 0; k < 8; ++k) {
+            const int nx = cx + NEIGHBOR_DX[k], ny = cy + NEIGHBOR_DY[k];
+            if (nx < 0 || ny < 0 || nx >= cols_ || ny >= rows_ || isBlocked(nx, ny)) continue;
+            // 斜走时两侧直走的格子都必须可通行，避免贴着障碍拐角穿过去
+            if (k >= 4 && (isBlocked(cx + NEIGHBOR_DX[k], cy) || isBlocked(cx, cy + NEIGHBOR_DY[k]))) continue;
+            const int nd = d + (k < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            const int ncell = ny * cols_ + nx;
+            if (nd < dist_[ncell]) {
+                dist_[ncell] = nd;
+                heap_.push_back({nd, ncell});
+                push_heap(heap_.begin(), heap_.end(), cmp);
+            }
+        }
+    }
+    // 每个格子指向距离最小的相邻格子
+    for (int cy = 0; cy < rows_; ++cy) {
+        for (int cx = 0; cx < cols_; ++cx) {
+            const int cell = cy * cols_ + cx;
+            dirX_[cell] = dirY_[cell] = 0;
+            // 离目标不超过一步时直接朝目标走，保证攻击距离判断按真实位置计算
+            if (blocked_[cell] || dist_[cell] <= DIAGONAL_COST) continue;
+            int best = dist_[cell], bestK = -1;
+            for (int k = 0; k < 8; ++k) {
+                const int nx = cx + NEIGHBOR_DX[k], ny = cy + NEIGHBOR_DY[k];
+                if (nx < 0 || ny < 0 || nx >= cols_ || ny >= rows_ || isBlocked(nx, ny)) continue;
+                if (k >= 4 && (isBlocked(cx + NEIGHBOR_DX[k], cy) || isBlocked(cx, cy + NEIGHBOR_DY[k]))) continue;
+                const int nd = dist_[ny * cols_ + nx];
+                if (nd < best) {
+                    best = nd;
+                    bestK = k;
+                }
+            }
+            if (bestK < 0) continue;
+            const float unit = bestK < 4 ? 1.0f : DIAGONAL_UNIT;
+            dirX_[cell] = NEIGHBOR_DX[bestK] * unit;
+            dirY_[cell] = NEIGHBOR_DY[bestK] * unit;
+        }
+    }
+}
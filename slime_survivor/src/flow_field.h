@@ -0,0 +1,71 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/**
+ * 网格流场寻路
+ * 以目标所在格子为起点做 Dijkstra（直走代价10，斜走代价14，不允许穿过障碍的拐角），
+ * 每个格子记录通往目标的下一步方向。敌人只需按所在格子查表，寻路开销与敌人数量无关
+ * 目标换格子时才重算，目标在同一格子内移动时直接复用上次结果
+ */
+class FlowField {
+public:
+    static const int DEFAULT_CELL_SIZE = 32;
+    static constexpr int UNREACHABLE = INT32_MAX;
+
+    /**
+     * 按世界尺寸划分网格，所有格子初始为可通行
+     */
+    void init(int worldW, int worldH, int cellSize = DEFAULT_CELL_SIZE);
+
+    /**
+     * 从碰撞层图片加载障碍：图片拉伸覆盖整个世界，格子中心处像素不透明（alpha >= 128）即为障碍
+     * 图片不存在时保持全部可通行，返回 false
+     */
+    bool loadBlocked(const char *path);
+
+    void setBlocked(int cx, int cy, bool blocked);
+    bool isBlocked(int cx, int cy) const { return blocked_[cy * cols_ + cx] != 0; }
+
+    /**
+     * 设置目标位置（世界坐标），目标换格子或障碍有变化时重算流场，返回是否重算
+     */
+    bool setGoal(int x, int y);
+
+    /**
+     * 世界坐标所在的格子下标，超出网格返回 -1
+     */
+    int cellAt(float x, float y) const {
+        if (x < 0 || y < 0) return -1;
+        const int cx = int(x) >> cellShift_, cy = int(y) >> cellShift_;
+        if (cx >= cols_ || cy >= rows_) return -1;
+        return cy * cols_ + cx;
+    }
+
+    /**
+     * 格子的前进方向（单位向量）；目标所在格及其相邻格、不可达格和障碍格为 (0, 0)，表示直接朝目标走
+     */
+    float dirX(int cell) const { return dirX_[cell]; }
+    float dirY(int cell) const { return dirY_[cell]; }
+    int distance(int cell) const { return dist_[cell]; }
+
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    int cellSize() const { return 1 << cellShift_; }
+    int rebuildCount() const { return rebuilds_; }
+
+private:
+    void rebuild();
+
+    int cols_ = 0, rows_ = 0;
+    int cellShift_ = 0;
+    int goalCell_ = -1;
+    bool dirty_ = true;
+    int rebuilds_ = 0;
+    vector<uint8_t> blocked_;
+    vector<int> dist_;
+    vector<float> dirX_, dirY_;
+    vector<pair<int, int>> heap_; // (距离, 格子)，预留容量后重算不再分配
+};
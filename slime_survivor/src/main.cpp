@@ -1,48 +1,153 @@
 #include<SDL2/SDL.h>
 #include<SDL2/SDL2_gfxPrimitives.h>
 #include<SDL2/SDL_image.h>
+#include<algorithm>
+#include<cstdlib>
 #include<string>
 #include<vector>
 #include "character.h"
+#include "enemy_swarm.h"
 #include "constants.h"
 #include "bullet.h"
 #include "audio_manager.h"
 #include "button.h"
+#include "spatial_grid.h"
+#include "sprite_batch.h"
+#include "resource_cache.h"
+#include "benchmark.h"
+#include "wave_spawner.h"
+#include "alloc_stats.h"
+#include "worker_pool.h"
+#include "flow_field.h"
+#include "asset_bundle.h"
+#include "profiler.h"
+#include "camera.h"
 using namespace std;
 
 const char* TITLE_PATH = "../img/title_bg.png";
 const char* BG_PATH = "../img/map.png";
+const char* BUNDLE_PATH = "../assets.bundle"; // tools/asset_bundler 生成，可缺省
+const char* ATLAS_MANIFEST_PATH = "../img/atlas/sprites.atlas"; // tools/atlas_packer 生成，可缺省
+const double LOAD_UPLOAD_BUDGET_MS = 4.0; // 加载界面每帧用于上传纹理的时间
+const char* COLLISION_PATH = "../img/map_collision.png"; // 碰撞层：不透明像素为障碍，可缺省
+const int DEFAULT_AI_BUDGET_US = 2000; // 敌人每步更新的默认时间预算，约为 60 帧下一帧的八分之一
 
 bool game_started = false;
 bool running = true;
 
+/**
+ * 启动参数
+ */
+struct LaunchOptions {
+    bool headless = false; // 无窗口、无音频，全速跑模拟并输出耗时
+    unsigned seed = 0;     // 随机种子，0 表示不固定
+    int enemies = 50;      // 开局第一波的敌人数
+    int ticks = 10000;     // headless 模式下模拟的步数
+    int threads = 0;       // 敌人更新使用的线程数，0 表示取硬件线程数
+    bool syncLoad = false; // 在主线程上逐个同步加载贴图（用于对比启动耗时）
+    bool noBundle = false; // 不使用资源包，全部从散文件加载（用于对比启动耗时）
+    string tracePath;      // 非空时记录分析区间，退出时按 Chrome trace 格式写到这里
+    int aiBudgetUs = -1;   // 敌人每步更新的时间预算（微秒），超出时远处敌人更新得更稀；-1 取默认值，0 表示固定间隔
+};
+LaunchOptions options;
+
+// 模拟各阶段累计耗时（性能计数器单位）
+enum SimPhase { PHASE_INPUT, PHASE_HERO, PHASE_ENEMIES, PHASE_GUARDIANS, PHASE_COLLISION, PHASE_SPAWN, PHASE_NUM };
+const char *SIM_PHASE_NAMES[PHASE_NUM] = {"input", "hero", "enemies", "guardians", "collision", "spawn"};
+Uint64 simPhaseCounters[PHASE_NUM] = {};
+
 SDL_Window *window;
 SDL_Renderer *renderer;
-SDL_Texture *bgTexture;
-SDL_Texture *titleTexture;
+shared_ptr<SDL_Texture> bgTexture;
+shared_ptr<SDL_Texture> titleTexture;
+int bgW = 0, bgH = 0;
 
 Hero hero;
 vector<Guardian> guardians;
-vector<Enemy> enemies;
+EnemySwarm enemies;
+WaveSpawner enemySpawner;
+WorkerPool workerPool;
+FlowField flowField;
+Camera camera;
 
 Button startBtn;
 Button quitBtn;
 
-
+SpriteBatch spriteBatch;
+SpatialGrid enemyGrid;
+vector<int> collisionCandidates;
 
 void cleanup() {
-    if (bgTexture) SDL_DestroyTexture(bgTexture);
-    if (titleTexture) SDL_DestroyTexture(titleTexture);
+    workerPool.stop();
+    AudioManager::getInstance().quit();
+    bgTexture.reset();
+    titleTexture.reset();
+    TextureCache::getInstance().clear();
+    AtlasIndexCache::getInstance().clear();
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
     IMG_Quit();
     SDL_Quit();
 }
 
+/**
+ * 绘制加载界面：屏幕中间一条进度条
+ */
+void renderLoadingScreen(float progress) {
+    const int barW = SCREEN_WIDTH / 2, barH = 16;
+    const SDL_Rect frame = {(SCREEN_WIDTH - barW) / 2, SCREEN_HEIGHT / 2 - barH / 2, barW, barH};
+    const SDL_Rect fill = {frame.x + 2, frame.y + 2, int((barW - 4) * progress), barH - 4};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+    SDL_RenderDrawRect(renderer, &frame);
+    SDL_SetRenderDrawColor(renderer, 90, 200, 90, 255);
+    SDL_RenderFillRect(renderer, &fill);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+}
+
+/**
+ * 异步加载所有贴图：后台线程并行解码，主线程每帧在时间预算内把解码好的图片上传为纹理，同时显示进度
+ * 返回 false 表示加载期间窗口被关闭
+ */
+bool loadAssetsAsync() {
+    const char *paths[] = {
+        TITLE_PATH, BG_PATH,
+        Hero::IDLE_PATH, Hero::WALK_PATH, Hero::HURT_PATH, Hero::ATTACK_PATH, Hero::DEATH_PATH,
+        EnemySwarm::IDLE_PATH, EnemySwarm::WALK_PATH, EnemySwarm::HURT_PATH, EnemySwarm::ATTACK_PATH, EnemySwarm::DEATH_PATH,
+        Guardian::ATLAS_PATH, Button::ATLAS_PATH,
+    };
+    TextureCache &cache = TextureCache::getInstance();
+    for (const char *path : paths) {
+        cache.preload(renderer, path);
+    }
+    SDL_Event event;
+    while (cache.preloadDone() < cache.preloadTotal()) {
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) return false;
+        }
+        cache.pumpUploads(LOAD_UPLOAD_BUDGET_MS);
+        if (options.headless) {
+            SDL_Delay(1);
+            continue;
+        }
+        renderLoadingScreen(float(cache.preloadDone()) / cache.preloadTotal());
+        SDL_RenderPresent(renderer);
+    }
+    return true;
+}
+
 /**
  * 初始化
  */
 bool init() {
+    if (options.headless) {
+        // 使用 dummy 视频驱动，不创建真实窗口
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+    if (options.seed != 0) {
+        Character::seedRandom(options.seed);
+    }
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         SDL_Log("SDL Init Error: %s", SDL_GetError());
         return false;
@@ -53,14 +158,14 @@ bool init() {
         SDL_Quit();
         return false;
     }
-    window = SDL_CreateWindow("Vampire", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    window = SDL_CreateWindow("Vampire", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, options.headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
     if (!window) {
         SDL_Log("SDL Create Window Error: %s", SDL_GetError());
         IMG_Quit();
         SDL_Quit();
         return false;
     }
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    renderer = SDL_CreateRenderer(window, -1, options.headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
         SDL_Log("SDL Create Renderer Error: %s", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -68,65 +173,67 @@ bool init() {
         SDL_Quit();
         return false;
     }
-    SDL_Surface *titleSurface = IMG_Load(TITLE_PATH);
-    if (!titleSurface) {
-        SDL_Log("SDL Load Image Error: %s", IMG_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        IMG_Quit();
-        SDL_Quit();
-        return false;
+    // 有资源包时，贴图、图集清单和音频都优先从包里取，不必再解码
+    if (!options.noBundle) {
+        AssetBundle::getInstance().open(BUNDLE_PATH);
     }
-    titleTexture = SDL_CreateTextureFromSurface(renderer, titleSurface);
-    SDL_FreeSurface(titleSurface);
-    if (!titleTexture) {
-        SDL_Log("SDL Create Texture Error: %s", SDL_GetError());
+    // 有图集清单时，角色、守护者和按钮的贴图都从图集页上取
+    TextureCache::getInstance().loadManifest(ATLAS_MANIFEST_PATH);
+    if (!options.syncLoad && !loadAssetsAsync()) {
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         IMG_Quit();
         SDL_Quit();
         return false;
     }
-    SDL_Surface *bgSurface = IMG_Load(BG_PATH);
-    if (!bgSurface) {
-        SDL_Log("SDL Load Image Error: %s", IMG_GetError());
+    // 异步加载过的贴图这里直接命中缓存，同步模式下在这里逐个加载
+    try {
+        titleTexture = TextureCache::getInstance().get(renderer, TITLE_PATH);
+        bgTexture = TextureCache::getInstance().get(renderer, BG_PATH);
+        SDL_QueryTexture(bgTexture.get(), nullptr, nullptr, &bgW, &bgH);
+    } catch (const exception &e) {
+        SDL_Log("%s", e.what());
+        TextureCache::getInstance().clear();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         IMG_Quit();
         SDL_Quit();
         return false;
     }
-    bgTexture = SDL_CreateTextureFromSurface(renderer, bgSurface);
-    SDL_FreeSurface(bgSurface);
-    if (!bgTexture) {
-        SDL_Log("SDL Create Texture Error: %s", SDL_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        IMG_Quit();
-        SDL_Quit();
-        return false;
+    // 初始化音频（headless 模式不打开音频设备）
+    if (!options.headless) {
+        if (!AudioManager::getInstance().init()) {
+            return false;
+        }
+        // 音乐按需打开：这里只打开菜单曲，战斗曲由后台线程预取
+        AudioManager::getInstance().playBGM(AudioManager::BGM_MENU);
     }
-    SDL_SetTextureBlendMode(bgTexture, SDL_BLENDMODE_BLEND);
-    // 初始化音频
-    if (!AudioManager::getInstance().init()) {
+    // 初始化英雄角色，出生在世界中央，摄像机跟随英雄
+    if (!hero.init(renderer, WORLD_WIDTH / 2 - Hero::SIZE / 2, WORLD_HEIGHT / 2 - Hero::SIZE / 2)) {
         return false;
     }
-    // 初始化英雄角色
-    if (!hero.init(renderer, SCREEN_WIDTH / 2 - Hero::SIZE / 2, SCREEN_HEIGHT / 2 - Hero::SIZE / 2)) {
+    camera.setWorldSize(WORLD_WIDTH, WORLD_HEIGHT);
+    camera.setViewSize(SCREEN_WIDTH, SCREEN_HEIGHT);
+    camera.lookAt(hero.center().x, hero.center().y);
+    // 初始化敌人
+    // 对象池和碰撞用的缓冲一次分配到上限，之后波次生成不再触发堆分配
+    const int enemyCapacity = max(options.enemies * 2, EnemySwarm::DEFAULT_CAPACITY);
+    if (!enemies.init(renderer, enemyCapacity)) {
         return false;
     }
-    int enemyNum = 50;
-    while (enemyNum--) {
-        Enemy enemy;
-        if (!enemy.init(renderer, SCREEN_WIDTH / 2 - Enemy::SIZE / 2, SCREEN_HEIGHT / 2 - Enemy::SIZE / 2)) {
-            return false;
-        }
-        SDL_Point pos = Character::randomSpawnOutsidePos(Enemy::SIZE, Enemy::SIZE, 100);
-        enemy.setPosition(pos.x, pos.y);
-        enemy.setSpeed(60);
-        enemy.setTarget(&hero);
-        enemies.push_back(enemy);
-    }
+    enemies.setSpeed(60);
+    enemies.setTarget(&hero);
+    // 预算按实际耗时调整，结果与机器快慢有关；headless 默认用固定间隔，保证同一种子结果可复现
+    SwarmLod lod;
+    lod.budgetUs = options.aiBudgetUs >= 0 ? options.aiBudgetUs : options.headless ? 0 : DEFAULT_AI_BUDGET_US;
+    enemies.setLod(lod);
+    flowField.init(WORLD_WIDTH, WORLD_HEIGHT);
+    flowField.loadBlocked(COLLISION_PATH);
+    enemies.setFlowField(&flowField);
+    enemyGrid.reserve(enemyCapacity);
+    collisionCandidates.reserve(enemyCapacity);
+    enemySpawner.spawnWave(enemies, options.enemies, camera.view());
+    workerPool.start(options.threads);
     int guardianNum = 3;
     while (guardianNum--) {
         Guardian guardian;
@@ -142,7 +249,7 @@ bool init() {
         return false;
     }
     startBtn.onClick = []() {
-        AudioManager::getInstance().playBGM(2);
+        AudioManager::getInstance().playBGM(AudioManager::BGM_BATTLE);
         game_started = true;
     };
     // 初始化退出按钮
@@ -155,80 +262,243 @@ bool init() {
     return true;
 }
 
-int main() {
+/**
+ * 碰撞检测：敌人登记到空间网格后，守护者只检测所在格子里的敌人
+ * （敌人对英雄的攻击判定在 EnemySwarm::update 中完成）
+ */
+void checkCollisions() {
+    PROFILE_ZONE("collision");
+    enemyGrid.clear();
+    for (int i = 0; i < enemies.size(); ++i) {
+        enemyGrid.insert(i, enemies.getHitRect(i));
+    }
+    enemyGrid.build();
+    for (auto &guardian : guardians) {
+        enemyGrid.query(*guardian.getHitRect(), collisionCandidates);
+        for (int i : collisionCandidates) {
+            guardian.checkCollision(enemies, i);
+        }
+    }
+    for (int i = enemies.size() - 1; i >= 0; --i) {
+        if (enemies.isAllOver(i)) {
+            enemies.release(i);
+        }
+    }
+}
+
+/**
+ * 推进一个固定步长的模拟：输入、更新、碰撞
+ */
+void simulateStep(float dt_ms, bool triggerAttack) {
+    PROFILE_ZONE("step");
+    Uint64 t0 = SDL_GetPerformanceCounter(), t1;
+    hero.beginStep();
+    enemies.beginStep();
+    hero.handleInput(SDL_GetKeyboardState(NULL), triggerAttack, dt_ms);
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_INPUT] += t1 - t0; t0 = t1;
+    hero.update(dt_ms);
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_HERO] += t1 - t0; t0 = t1;
+    const SDL_Point heroCenter = hero.center();
+    // 模拟用的视口按英雄的模拟位置计算，与渲染帧率无关，headless 下结果也可复现
+    const SDL_Rect simView = camera.viewAt(heroCenter.x, heroCenter.y);
+    flowField.setGoal(heroCenter.x, heroCenter.y);
+    enemies.setAnimView(simView);
+    enemies.update(dt_ms, &workerPool);
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_ENEMIES] += t1 - t0; t0 = t1;
+    for (auto &guardian : guardians) {
+        guardian.update(dt_ms);
+    }
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_GUARDIANS] += t1 - t0; t0 = t1;
+    checkCollisions();
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_COLLISION] += t1 - t0; t0 = t1;
+    enemySpawner.update(dt_ms, enemies, simView);
+    t1 = SDL_GetPerformanceCounter(); simPhaseCounters[PHASE_SPAWN] += t1 - t0;
+    if (hero.isAllOver()) {
+        running = false;
+    }
+}
+
+/**
+ * 渲染游戏场景，alpha 为上一步到当前步之间的插值系数
+ */
+void renderScene(float alpha) {
+    PROFILE_ZONE("render");
+    // 摄像机跟随插值后的英雄位置，避免画面随模拟步抖动
+    const SDL_Point heroCenter = hero.centerAt(alpha);
+    camera.lookAt(heroCenter.x, heroCenter.y);
+    SDL_RenderClear(renderer);
+    // 背景图拉伸覆盖整个世界，只取视口对应的部分
+    const SDL_Rect &view = camera.view();
+    const SDL_Rect bgSrc = {view.x * bgW / WORLD_WIDTH, view.y * bgH / WORLD_HEIGHT, view.w * bgW / WORLD_WIDTH, view.h * bgH / WORLD_HEIGHT};
+    SDL_RenderCopy(renderer, bgTexture.get(), &bgSrc, NULL);
+    // 按层提交：敌人、英雄、守护者，层内同纹理合并为一次绘制；全部来自同一图集页时整个场景只绘制一次
+    spriteBatch.begin(renderer);
+    enemies.render(spriteBatch, camera, alpha);
+    spriteBatch.endLayer();
+    hero.render(spriteBatch, camera, alpha);
+    spriteBatch.endLayer();
+    for (auto &guardian : guardians) {
+        guardian.render(spriteBatch, camera, alpha);
+    }
+    spriteBatch.flush();
+}
+
+/**
+ * headless 模式：不渲染、不处理输入，按固定步长全速模拟，输出吞吐和各阶段耗时
+ */
+int runHeadless() {
+    SDL_Log("headless: seed=%u enemies=%d ticks=%d threads=%d", options.seed, options.enemies, options.ticks, workerPool.threadCount());
+    game_started = true;
+    int heroDeathTick = -1;
+    const AllocStats allocStart = allocStats();
+    const Uint64 start = SDL_GetPerformanceCounter();
+    for (int tick = 0; tick < options.ticks; ++tick) {
+        simulateStep(SIM_STEP_MS, false);
+        // 英雄死亡后继续模拟，保证每次测量的步数一致
+        if (!running && heroDeathTick < 0) heroDeathTick = tick;
+        Profiler::getInstance().endFrame();
+    }
+    const double totalMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    const AllocStats allocs = allocStats() - allocStart;
+    const double toUs = 1000000.0 / SDL_GetPerformanceFrequency();
+    printf("ticks: %d  wall: %.1f ms  ticks/sec: %.0f\n", options.ticks, totalMs, options.ticks * 1000.0 / totalMs);
+    printf("%-10s %12s %10s\n", "phase", "total ms", "us/tick");
+    for (int p = 0; p < PHASE_NUM; ++p) {
+        const double us = simPhaseCounters[p] * toUs;
+        printf("%-10s %12.2f %10.2f\n", SIM_PHASE_NAMES[p], us / 1000.0, us / options.ticks);
+    }
+    printf("enemies alive: %d/%d  waves: %d  hero died at tick: %d\n", enemies.size(), enemies.capacity(), enemySpawner.wave(), heroDeathTick);
+    const SwarmLodStats &lod = enemies.lodStats();
+    printf("enemy LOD: steered last tick: %d/%d  budget: %d us  avg update: %.1f us  extra shift: %d\n",
+           lod.steered, enemies.size(), enemies.lod().budgetUs, lod.updateUs, lod.extraShift);
+    printf("heap allocs in sim loop: %llu (%.3f/tick, %llu bytes)  frees: %llu\n",
+           (unsigned long long)allocs.allocs, double(allocs.allocs) / options.ticks,
+           (unsigned long long)allocs.bytes, (unsigned long long)allocs.frees);
+    return 0;
+}
+
+/**
+ * 解析命令行参数，返回 false 表示参数有误
+ */
+bool parseArgs(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--enemies" && hasValue) {
+            options.enemies = atoi(argv[++i]);
+        } else if (arg == "--ticks" && hasValue) {
+            options.ticks = atoi(argv[++i]);
+        } else if (arg == "--sync-load") {
+            options.syncLoad = true;
+        } else if (arg == "--no-bundle") {
+            options.noBundle = true;
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--ai-budget" && hasValue) {
+            options.aiBudgetUs = atoi(argv[++i]);
+        } else {
+            SDL_Log("未知参数: %s", arg.c_str());
+            SDL_Log("用法: main [--headless] [--seed N] [--enemies N] [--ticks N] [--threads N] [--sync-load] [--no-bundle] [--trace out.json] [--ai-budget US] | --bench <name>");
+            return false;
+        }
+    }
+    if (options.enemies < 0) options.enemies = 0;
+    if (options.ticks < 1) options.ticks = 1;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 3 && string(argv[1]) == "--bench") {
+        return runBenchmark(argv[2]);
+    }
+    const Uint64 launchCounter = SDL_GetPerformanceCounter();
+    if (!parseArgs(argc, argv)) {
+        return 1;
+    }
+    Profiler::setThreadName("main");
+    if (!options.tracePath.empty()) {
+        Profiler::getInstance().startTrace();
+    }
     // 初始化游戏
     if (!init()) {
         SDL_Log("初始化失败！");
         return 1;
     }
-    Uint32 nowTick;
-    Uint32 lastTick = SDL_GetTicks();
-    Uint32 deltaTick;
+    SDL_Log("启动耗时: %.1f ms（%s加载，%s）", (SDL_GetPerformanceCounter() - launchCounter) * 1000.0 / SDL_GetPerformanceFrequency(),
+            options.syncLoad ? "同步" : "异步", AssetBundle::getInstance().isOpen() ? "资源包" : "散文件");
+    if (options.headless) {
+        int code = runHeadless();
+        if (!options.tracePath.empty()) Profiler::getInstance().writeTrace(options.tracePath);
+        cleanup();
+        return code;
+    }
+    const double counterToMs = 1000.0 / SDL_GetPerformanceFrequency();
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+    double accumulatorMs = 0;
     SDL_Event event;
-    bool triggerAttack;
+    bool triggerAttack = false; // 跨帧保留，直到被某个模拟步消费
     while (running) {
-        triggerAttack = false;
-        if (SDL_WaitEventTimeout(&event, 5)) { // 阻塞一小会，或直到读取事件，节省CPU
-            do {
-                if (event.type == SDL_QUIT) running = false;
-                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) triggerAttack = true;
-                startBtn.handleMouseInput(event);
-                quitBtn.handleMouseInput(event);
-            } while (SDL_PollEvent(&event));
+        {
+            PROFILE_ZONE("input"); // 含等待事件的时间
+            if (SDL_WaitEventTimeout(&event, 5)) { // 阻塞一小会，或直到读取事件，节省CPU
+                do {
+                    if (event.type == SDL_QUIT) running = false;
+                    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) running = false;
+                    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) triggerAttack = true;
+                    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) Profiler::getInstance().toggleOverlay();
+                    startBtn.handleMouseInput(event);
+                    quitBtn.handleMouseInput(event);
+                } while (SDL_PollEvent(&event));
+            }
+        }
+        const Uint64 nowCounter = SDL_GetPerformanceCounter();
+        const double frameMs = (nowCounter - lastCounter) * counterToMs;
+        lastCounter = nowCounter;
+        {
+            PROFILE_ZONE("audio");
+            AudioManager::getInstance().update();
         }
 
         if (!game_started) {
             // 渲染
+            PROFILE_ZONE("render");
+            triggerAttack = false;
             SDL_RenderClear(renderer);
-            SDL_RenderCopy(renderer, titleTexture, NULL, NULL);
+            SDL_RenderCopy(renderer, titleTexture.get(), NULL, NULL);
             startBtn.render();
             quitBtn.render();
         } else {
-            // 更新数据
-            nowTick = SDL_GetTicks();
-            deltaTick = nowTick - lastTick;
-            lastTick = nowTick;
-            hero.handleInput(SDL_GetKeyboardState(NULL), triggerAttack, deltaTick);
-            hero.update(deltaTick);
-            for (auto &enemy : enemies) {
-                enemy.update(deltaTick);
-            }
-            for (auto &guardian : guardians) {
-                guardian.update(deltaTick);
+            // 固定步长更新，单帧最多追赶 MAX_SIM_STEPS_PER_FRAME 步，超出的时间直接丢弃，避免越追越慢
+            accumulatorMs += frameMs;
+            if (accumulatorMs > SIM_STEP_MS * MAX_SIM_STEPS_PER_FRAME) {
+                accumulatorMs = SIM_STEP_MS * MAX_SIM_STEPS_PER_FRAME;
             }
-
-            // 渲染
-            SDL_RenderClear(renderer);
-            SDL_RenderCopy(renderer, bgTexture, NULL, NULL);
-            for (auto &enemy : enemies) {
-                enemy.render();
-            }
-            hero.render();
-            for (auto &guardian : guardians) {
-                guardian.render();
-            }
-            
-            // 碰撞检测
-            for (auto &enemy : enemies) {
-                enemy.checkTargetCollision();
-            }
-            for (auto &guardian : guardians) {
-                for (int i = enemies.size() - 1; i >= 0; --i) {
-                    Enemy &enemy = enemies[i];
-                    guardian.checkCollision(enemy);
-                    if (enemy.isAllOver()) {
-                        swap(enemy, enemies.back());
-                        enemies.pop_back();
-                    }
+            {
+                PROFILE_ZONE("update");
+                while (accumulatorMs >= SIM_STEP_MS) {
+                    simulateStep(SIM_STEP_MS, triggerAttack);
+                    triggerAttack = false; // 攻击只触发一次
+                    accumulatorMs -= SIM_STEP_MS;
                 }
             }
-            if (hero.isAllOver()) {
-                running = false;
-            }
+
+            // 渲染（在上一步和当前步之间插值）
+            renderScene(float(accumulatorMs / SIM_STEP_MS));
         }
-        SDL_RenderPresent(renderer);
+        Profiler::getInstance().renderOverlay(renderer);
+        {
+            PROFILE_ZONE("present");
+            SDL_RenderPresent(renderer);
+        }
+        Profiler::getInstance().endFrame();
     }
+    if (!options.tracePath.empty()) Profiler::getInstance().writeTrace(options.tracePath);
     cleanup();
     return 0;
-}
\ No newline at end of file
+}
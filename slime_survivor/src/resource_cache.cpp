@@ -1,6 +1,9 @@
+#include <fstream>
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 #include "resource_cache.h"
+#include "asset_bundle.h"
 
 static auto make_tex_deleter() {
     return [](SDL_Texture* t) {
@@ -10,6 +13,8 @@ static auto make_tex_deleter() {
     };
 }
 
+static const int MAX_DECODE_THREADS = 4;
+
 static SDL_Texture *loadTexture(SDL_Renderer *r, const string &path) {
     SDL_Surface *surf = IMG_Load(path.c_str());
     if (!surf) throw runtime_error("SDL Load Image Error: " + string(IMG_GetError()));
@@ -20,22 +25,45 @@ static SDL_Texture *loadTexture(SDL_Renderer *r, const string &path) {
     return tex;
 }
 
-static AtlasIndex makeAtlasIndexFromAtlas(SDL_Texture *atlas, int frameW, int frameH, int startX, int startY, int rows, int cols) {
-    int atlasW = 0, atlasH = 0;
-    SDL_QueryTexture(atlas, nullptr, nullptr, &atlasW, &atlasH);
-    AtlasIndex idx = {{}, frameW, frameH};
-    auto &vec = idx.frames;
-    vec.resize(rows);
+/**
+ * 从资源包里预解码的像素直接创建纹理，不在包中时返回 nullptr
+ */
+static SDL_Texture *loadTextureFromBundle(SDL_Renderer *r, const string &path) {
+    BundleImage img;
+    if (!AssetBundle::getInstance().image(path, img)) return nullptr;
+    // 表面只是映射区像素的一个视图，不拷贝；创建纹理时直接从映射区上传
+    SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<void *>(img.pixels), img.w, img.h, 32, img.pitch, SDL_PIXELFORMAT_RGBA32);
+    if (!surf) throw runtime_error("SDL Create Surface Error: " + string(SDL_GetError()));
+    SDL_Texture *tex = SDL_CreateTextureFromSurface(r, surf);
+    SDL_FreeSurface(surf);
+    if (!tex) throw runtime_error("SDL Create Texture Error: " + string(SDL_GetError()));
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    return tex;
+}
+
+/**
+ * 填充帧表：有编译期表且不需要偏移时直接引用，否则在 storage 中生成
+ */
+static void fillAtlasIndex(AtlasIndex &idx, const SDL_Rect *table, int frameW, int frameH, int offsetX, int offsetY, int startX, int startY, int rows, int cols) {
+    idx.frameW = frameW;
+    idx.frameH = frameH;
+    idx.rows = rows;
+    idx.cols = cols;
+    if (table && offsetX == 0 && offsetY == 0) {
+        idx.frames = table;
+        return;
+    }
+    idx.storage.resize(rows * cols);
     for (int row = 0; row < rows; ++row) {
-        vec[row].reserve(cols);
         for (int c = 0; c < cols; ++c) {
-            SDL_Rect rect = {startX + c * frameW, startY + row * frameH, frameW, frameH};
-            vec[row].push_back(rect);
+            const int i = row * cols + c;
+            SDL_Rect rect = table ? table[i] : SDL_Rect{startX + c * frameW, startY + row * frameH, frameW, frameH};
+            rect.x += offsetX;
+            rect.y += offsetY;
+            idx.storage[i] = rect;
         }
     }
-    idx.rows = rows;
-    idx.cols = cols;
-    return idx;
+    idx.frames = idx.storage.data();
 }
 
 TextureCache &TextureCache::getInstance() {
@@ -43,37 +71,281 @@ TextureCache &TextureCache::getInstance() {
     return instance;
 }
 
-shared_ptr<SDL_Texture> TextureCache::get(SDL_Renderer *r, const string &path) {
-    ostringstream oss;
-    oss << r << '|' << path;
-    const string key = oss.str();
-    if (auto sp = cache_[key].lock()) return sp;
-    auto raw = loadTexture(r, path);
+bool TextureCache::loadManifest(const string &manifestPath) {
+    // 优先从资源包读取清单
+    const Uint8 *bundled;
+    size_t bundledSize;
+    istringstream bundledIn;
+    ifstream fileIn;
+    if (AssetBundle::getInstance().raw(manifestPath, bundled, bundledSize)) {
+        bundledIn.str(string((const char *)bundled, bundledSize));
+    } else {
+        fileIn.open(manifestPath);
+        if (!fileIn) {
+            SDL_Log("未找到图集清单 %s，按独立图片加载", manifestPath.c_str());
+            return false;
+        }
+    }
+    istream &in = fileIn.is_open() ? (istream &)fileIn : bundledIn;
+    // 图集页路径相对于清单所在目录
+    const size_t slash = manifestPath.find_last_of("/\\");
+    const string dir = slash == string::npos ? "" : manifestPath.substr(0, slash + 1);
+    vector<string> pages;
+    unordered_map<string, Region> regions;
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream iss(line);
+        string kind;
+        iss >> kind;
+        if (kind == "page") {
+            string file;
+            iss >> file;
+            pages.push_back(dir + file);
+        } else if (kind == "sprite") {
+            string path;
+            size_t page = 0;
+            Region region;
+            iss >> path >> page >> region.rect.x >> region.rect.y >> region.rect.w >> region.rect.h;
+            if (!iss || page >= pages.size()) {
+                SDL_Log("图集清单 %s 格式错误: %s", manifestPath.c_str(), line.c_str());
+                return false;
+            }
+            region.page = pages[page];
+            regions[path] = region;
+        }
+    }
+    regions_ = move(regions);
+    SDL_Log("已加载图集清单 %s：%d 页，%d 张图", manifestPath.c_str(), (int)pages.size(), (int)regions_.size());
+    return true;
+}
+
+bool TextureCache::regionOf(const string &path, SDL_Rect &out) const {
+    auto it = regions_.find(path);
+    if (it == regions_.end()) return false;
+    out = it->second.rect;
+    return true;
+}
+
+TextureId TextureCache::intern(SDL_Renderer *r, const string &requested) {
+    auto region = regions_.find(requested);
+    const string &path = region == regions_.end() ? requested : region->second.page;
+    // 预加载中的槽位还没有纹理，不能被回收
+    return registry_.intern({r, path}, [this](int slot) { return pending_.count(slot) > 0; });
+}
+
+shared_ptr<SDL_Texture> TextureCache::get(TextureId id) {
+    if (!registry_.alive(id)) return nullptr;
+    if (auto sp = registry_.lock(id)) return sp;
+    // 已在预加载中：等它解码完，直接在这里上传，不再重复解码
+    auto pendingIt = pending_.find(id.slot);
+    if (pendingIt != pending_.end()) {
+        shared_ptr<PendingLoad> load = pendingIt->second;
+        {
+            unique_lock<mutex> lock(decodeMutex_);
+            decodedCv_.wait(lock, [&]() { return load->decoded; });
+            uploadQueue_.erase(find(uploadQueue_.begin(), uploadQueue_.end(), load));
+        }
+        auto tex = upload(load);
+        if (!tex) throw runtime_error(load->error);
+        return tex;
+    }
+    const TextureKey &key = registry_.key(id);
+    auto raw = loadTextureFromBundle(key.renderer, key.path);
+    if (!raw) raw = loadTexture(key.renderer, key.path);
     shared_ptr<SDL_Texture> tex(raw, make_tex_deleter());
-    cache_[key] = tex;
+    registry_.store(id, tex);
+    return tex;
+}
+
+shared_future<shared_ptr<SDL_Texture>> TextureCache::preload(SDL_Renderer *r, const string &requested) {
+    const TextureId id = intern(r, requested);
+    const string path = registry_.key(id).path;
+    auto it = pending_.find(id.slot);
+    if (it != pending_.end()) return it->second->future;
+    preloadTotal_++;
+    if (auto sp = registry_.lock(id)) {
+        preloadDone_++;
+        promise<shared_ptr<SDL_Texture>> ready;
+        ready.set_value(sp);
+        return ready.get_future().share();
+    }
+    // 资源包里的图片已经解码好，直接在这里创建纹理，不必经过解码线程
+    try {
+        if (SDL_Texture *raw = loadTextureFromBundle(r, path)) {
+            shared_ptr<SDL_Texture> tex(raw, make_tex_deleter());
+            registry_.store(id, tex);
+            preloaded_.push_back(tex);
+            preloadDone_++;
+            promise<shared_ptr<SDL_Texture>> ready;
+            ready.set_value(tex);
+            return ready.get_future().share();
+        }
+    } catch (const exception &e) {
+        SDL_Log("资源包中的 %s 无法使用，改为从文件加载: %s", path.c_str(), e.what());
+    }
+    auto load = make_shared<PendingLoad>();
+    load->renderer = r;
+    load->id = id;
+    load->path = path;
+    load->future = load->done.get_future().share();
+    pending_[id.slot] = load;
+    startDecoders();
+    {
+        lock_guard<mutex> lock(decodeMutex_);
+        decodeQueue_.push_back(load);
+    }
+    decodeCv_.notify_one();
+    return load->future;
+}
+
+TextureCache::~TextureCache() {
+    stopDecoders();
+    for (auto &kv : pending_) {
+        if (kv.second->surface) SDL_FreeSurface(kv.second->surface);
+    }
+}
+
+void TextureCache::startDecoders() {
+    if (!decoders_.empty()) return;
+    int n = min(MAX_DECODE_THREADS, (int)thread::hardware_concurrency());
+    if (n < 1) n = 1;
+    stopping_ = false;
+    for (int i = 0; i < n; ++i) {
+        decoders_.emplace_back([this]() { decodeLoop(); });
+    }
+}
+
+void TextureCache::stopDecoders() {
+    if (decoders_.empty()) return;
+    {
+        lock_guard<mutex> lock(decodeMutex_);
+        stopping_ = true;
+    }
+    decodeCv_.notify_all();
+    for (auto &t : decoders_) {
+        t.join();
+    }
+    decoders_.clear();
+}
+
+void TextureCache::decodeLoop() {
+    for (;;) {
+        shared_ptr<PendingLoad> load;
+        {
+            unique_lock<mutex> lock(decodeMutex_);
+            decodeCv_.wait(lock, [this]() { return stopping_ || !decodeQueue_.empty(); });
+            if (stopping_) return;
+            load = decodeQueue_.front();
+            decodeQueue_.pop_front();
+        }
+        // 解码后顺便转换成渲染器常用的像素格式，主线程创建纹理时就不必再转换
+        string error;
+        SDL_Surface *surf = IMG_Load(load->path.c_str());
+        if (surf) {
+            SDL_Surface *converted = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+            if (converted) {
+                SDL_FreeSurface(surf);
+                surf = converted;
+            }
+        } else {
+            error = "SDL Load Image Error: " + string(IMG_GetError());
+        }
+        {
+            lock_guard<mutex> lock(decodeMutex_);
+            load->surface = surf;
+            load->error = error;
+            load->decoded = true;
+            uploadQueue_.push_back(load);
+        }
+        decodedCv_.notify_all();
+    }
+}
+
+shared_ptr<SDL_Texture> TextureCache::upload(const shared_ptr<PendingLoad> &load) {
+    pending_.erase(load->id.slot);
+    preloadDone_++;
+    shared_ptr<SDL_Texture> tex;
+    if (load->surface) {
+        SDL_Texture *raw = SDL_CreateTextureFromSurface(load->renderer, load->surface);
+        SDL_FreeSurface(load->surface);
+        load->surface = nullptr;
+        if (raw) {
+            SDL_SetTextureBlendMode(raw, SDL_BLENDMODE_BLEND);
+            tex = shared_ptr<SDL_Texture>(raw, make_tex_deleter());
+            registry_.store(load->id, tex);
+            preloaded_.push_back(tex);
+        } else {
+            load->error = "SDL Create Texture Error: " + string(SDL_GetError());
+        }
+    }
+    if (!tex) SDL_Log("预加载失败 %s: %s", load->path.c_str(), load->error.c_str());
+    load->done.set_value(tex);
     return tex;
 }
 
+int TextureCache::pumpUploads(double budgetMs) {
+    const Uint64 start = SDL_GetPerformanceCounter();
+    const double counterToMs = 1000.0 / SDL_GetPerformanceFrequency();
+    int uploaded = 0;
+    for (;;) {
+        shared_ptr<PendingLoad> load;
+        {
+            lock_guard<mutex> lock(decodeMutex_);
+            if (uploadQueue_.empty()) break;
+            load = uploadQueue_.front();
+            uploadQueue_.pop_front();
+        }
+        upload(load);
+        uploaded++;
+        if ((SDL_GetPerformanceCounter() - start) * counterToMs >= budgetMs) break;
+    }
+    return uploaded;
+}
+
 void TextureCache::clear() {
-    cache_.clear();
+    // 先停下解码线程，正在解码的图片会完成并进入上传队列
+    stopDecoders();
+    for (auto &kv : pending_) {
+        if (kv.second->surface) SDL_FreeSurface(kv.second->surface);
+        kv.second->surface = nullptr;
+        kv.second->done.set_value(nullptr);
+    }
+    pending_.clear();
+    decodeQueue_.clear();
+    uploadQueue_.clear();
+    preloaded_.clear();
+    preloadDone_ = preloadTotal_ = 0;
+    registry_.clear();
 }
 
+
 AtlasIndexCache &AtlasIndexCache::getInstance() {
     static AtlasIndexCache instance;
     return instance;
 }
 
-shared_ptr<const AtlasIndex> AtlasIndexCache::get(SDL_Texture *atlas, const string &path, int frameW, int frameH, int startX, int startY, int rows, int cols) {
-    ostringstream oss;
-    oss << path << '#' << frameW << '#' << frameH << '#' << startX << '#' << startY << '#' << rows << '#' << cols;
-    const string key = oss.str();
-    if (auto sp = cache_[key].lock()) return sp;
-    AtlasIndex raw = makeAtlasIndexFromAtlas(atlas, frameW, frameH, startX, startY, rows, cols);
-    shared_ptr<const AtlasIndex> atlasIndex = make_shared<const AtlasIndex>(raw);
-    cache_[key] = atlasIndex;
+AtlasId AtlasIndexCache::intern(const string &path, int frameW, int frameH, int startX, int startY, int rows, int cols) {
+    return registry_.intern({path, frameW, frameH, startX, startY, rows, cols});
+}
+
+AtlasId AtlasIndexCache::intern(const string &path, const ClipDesc &clip) {
+    return registry_.intern({path, clip.frameW, clip.frameH, clip.startX, clip.startY, clip.rows, clip.cols, clip.frames});
+}
+
+shared_ptr<const AtlasIndex> AtlasIndexCache::get(AtlasId id, SDL_Texture *) {
+    if (!registry_.alive(id)) return nullptr;
+    if (auto sp = registry_.lock(id)) return sp;
+    const AtlasKey &key = registry_.key(id);
+    // path 在图集清单中时，帧坐标要加上它在图集页上的偏移
+    SDL_Rect region{};
+    TextureCache::getInstance().regionOf(key.path, region);
+    auto atlasIndex = make_shared<AtlasIndex>();
+    fillAtlasIndex(*atlasIndex, key.table, key.frameW, key.frameH, region.x, region.y, key.startX, key.startY, key.rows, key.cols);
+    registry_.store(id, atlasIndex);
     return atlasIndex;
 }
 
 void AtlasIndexCache::clear() {
-    cache_.clear();
+    registry_.clear();
 }
\ No newline at end of file
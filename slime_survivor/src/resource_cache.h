@@ -1,25 +1,277 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 using namespace std;
 
+static inline void hash_combine(size_t &seed, size_t v) {
+    seed ^= v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/**
+ * 动画帧表：rows*cols 个帧矩形按行连续存放，第 row 行第 col 帧为 frames[row * cols + col]
+ * frames 指向编译期生成的 ClipGrid 表，或运行期生成的 storage（数据驱动的图集、需要加图集页偏移时）
+ */
 struct AtlasIndex {
-    vector<vector<SDL_Rect> > frames;
+    const SDL_Rect *frames = nullptr;
     int frameW{}, frameH{}, rows{}, cols{};
+    vector<SDL_Rect> storage;
+
+    AtlasIndex() = default;
+    AtlasIndex(const AtlasIndex &) = delete; // frames 可能指向自身的 storage，不允许拷贝
+    AtlasIndex &operator=(const AtlasIndex &) = delete;
+
+    const SDL_Rect &frame(int row, int col) const { return frames[row * cols + col]; }
+};
+
+/**
+ * 编译期已知几何的动画 clip 描述，frames 指向 ClipGrid 生成的帧表
+ */
+struct ClipDesc {
+    int frameW, frameH, startX, startY, rows, cols;
+    const SDL_Rect *frames;
+};
+
+/**
+ * 在编译期生成等大网格排布的帧表，例如 ClipGrid<64, 64, 0, 0, 4, 8>::DESC
+ */
+template <int FrameW, int FrameH, int StartX, int StartY, int Rows, int Cols>
+struct ClipGrid {
+    static constexpr array<SDL_Rect, Rows * Cols> makeFrames() {
+        array<SDL_Rect, Rows * Cols> out{};
+        for (int r = 0; r < Rows; ++r) {
+            for (int c = 0; c < Cols; ++c) {
+                out[r * Cols + c] = {StartX + c * FrameW, StartY + r * FrameH, FrameW, FrameH};
+            }
+        }
+        return out;
+    }
+
+    static constexpr array<SDL_Rect, Rows * Cols> FRAMES = makeFrames();
+    static constexpr ClipDesc DESC = {FrameW, FrameH, StartX, StartY, Rows, Cols, FRAMES.data()};
+};
+
+/**
+ * 资源句柄：槽位下标 + 代数，槽位被回收后旧句柄失效
+ */
+template <typename Tag>
+struct AssetId {
+    int slot = -1;
+    Uint32 generation = 0;
+    bool valid() const { return slot >= 0; }
+};
+
+typedef AssetId<struct TextureTag> TextureId;
+typedef AssetId<struct AtlasTag> AtlasId;
+
+/**
+ * 资源登记表：key 只在第一次登记时哈希一次，之后凭句柄按下标取值
+ * 槽位只保存弱引用，值过期的槽位在登记新 key 时批量回收复用
+ */
+template <typename Tag, typename Key, typename T, typename Hash = hash<Key>>
+class AssetRegistry {
+public:
+    typedef AssetId<Tag> Id;
+
+    /**
+     * 查找或分配 key 的槽位；pinned(slot) 为 true 的槽位即使值已过期也不回收
+     */
+    template <typename Pinned>
+    Id intern(const Key &key, Pinned pinned) {
+        auto it = ids_.find(key);
+        if (it != ids_.end()) return {it->second, slots_[it->second].generation};
+        if (freeSlots_.empty() && used_ >= reclaimAt_) {
+            reclaimExpired(pinned);
+        }
+        int slot;
+        if (!freeSlots_.empty()) {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            slot = (int)slots_.size();
+            slots_.emplace_back();
+        }
+        Slot &s = slots_[slot];
+        s.key = key;
+        s.used = true;
+        used_++;
+        ids_.emplace(key, slot);
+        return {slot, s.generation};
+    }
+
+    Id intern(const Key &key) {
+        return intern(key, [](int) { return false; });
+    }
+
+    /**
+     * 句柄是否仍指向原来的 key
+     */
+    bool alive(Id id) const {
+        return id.slot >= 0 && id.slot < (int)slots_.size() && slots_[id.slot].used && slots_[id.slot].generation == id.generation;
+    }
+
+    const Key &key(Id id) const { return slots_[id.slot].key; }
+
+    shared_ptr<T> lock(Id id) const {
+        return alive(id) ? slots_[id.slot].value.lock() : nullptr;
+    }
+
+    void store(Id id, const shared_ptr<T> &value) {
+        if (alive(id)) slots_[id.slot].value = value;
+    }
+
+    /**
+     * 回收值已过期的槽位，返回回收的数量
+     */
+    template <typename Pinned>
+    int reclaimExpired(Pinned pinned) {
+        int reclaimed = 0;
+        for (int i = 0; i < (int)slots_.size(); ++i) {
+            Slot &s = slots_[i];
+            if (!s.used || !s.value.expired() || pinned(i)) continue;
+            release(i);
+            reclaimed++;
+        }
+        reclaimAt_ = max(MIN_RECLAIM_AT, used_ * 2);
+        return reclaimed;
+    }
+
+    /**
+     * 清空所有槽位，已发出的句柄全部失效
+     */
+    void clear() {
+        for (int i = 0; i < (int)slots_.size(); ++i) {
+            if (slots_[i].used) release(i);
+        }
+        reclaimAt_ = MIN_RECLAIM_AT;
+    }
+
+    int size() const { return used_; }
+
+private:
+    static constexpr int MIN_RECLAIM_AT = 64;
+
+    struct Slot {
+        Key key{};
+        Uint32 generation = 0;
+        bool used = false;
+        weak_ptr<T> value;
+    };
+
+    void release(int i) {
+        Slot &s = slots_[i];
+        ids_.erase(s.key);
+        s.key = Key{};
+        s.value.reset();
+        s.used = false;
+        s.generation++;
+        used_--;
+        freeSlots_.push_back(i);
+    }
+
+    vector<Slot> slots_;
+    vector<int> freeSlots_;
+    unordered_map<Key, int, Hash> ids_;
+    int used_ = 0;
+    int reclaimAt_ = MIN_RECLAIM_AT;
+};
+
+struct TextureKey {
+    SDL_Renderer *renderer;
+    string path;
+    bool operator==(const TextureKey &o) const {
+        return renderer == o.renderer && path == o.path;
+    }
+};
+
+struct TextureKeyHash {
+    size_t operator()(const TextureKey &k) const {
+        size_t h = 0;
+        hash_combine(h, hash<SDL_Renderer *>{}(k.renderer));
+        hash_combine(h, hash<string>{}(k.path));
+        return h;
+    }
+};
+
+struct AtlasKey {
+    string path;
+    int frameW, frameH, startX, startY, rows, cols;
+    const SDL_Rect *table = nullptr; // 编译期帧表，运行期生成时为空
+    bool operator==(const AtlasKey &o) const {
+        return frameW == o.frameW && frameH == o.frameH && startX == o.startX && startY == o.startY
+            && rows == o.rows && cols == o.cols && table == o.table && path == o.path;
+    }
+};
+
+struct AtlasKeyHash {
+    size_t operator()(const AtlasKey &k) const {
+        size_t h = hash<string>{}(k.path);
+        for (int v : {k.frameW, k.frameH, k.startX, k.startY, k.rows, k.cols}) {
+            hash_combine(h, hash<int>{}(v));
+        }
+        return h;
+    }
 };
 
 class TextureCache {
 public:
     static TextureCache &getInstance();
-    
+
+    /**
+     * 加载图集清单（由 tools/atlas_packer 生成），之后清单里的路径都解析到图集页上的子区域
+     * 清单不存在时返回 false，所有路径仍按独立图片加载
+     */
+    bool loadManifest(const string &manifestPath);
+
+    /**
+     * 获取纹理，同一对renderer、path只加载一次；path 在图集清单中时返回所在的图集页
+     */
+    shared_ptr<SDL_Texture> get(SDL_Renderer *r, const string &path) { return get(intern(r, path)); }
+
+    /**
+     * 登记 renderer、path 对应的纹理句柄但不加载；之后用 get(id) 取纹理，不再拼接或哈希字符串
+     */
+    TextureId intern(SDL_Renderer *r, const string &path);
+
+    /**
+     * 按句柄获取纹理，第一次取或纹理已被释放时加载；句柄已失效（槽位被回收或 clear 过）时返回空指针
+     */
+    shared_ptr<SDL_Texture> get(TextureId id);
+
+    /**
+     * 异步预加载：图片在后台线程解码，纹理在主线程调用 pumpUploads 时创建
+     * 资源包（AssetBundle）中有预解码像素的图片不经过解码线程，直接创建纹理
+     * 返回的 future 在纹理创建后就绪（加载失败时为空指针）；上传发生在主线程，不能在主线程上阻塞等待它
+     * 预加载中的 path 也可以直接调用 get，会等待解码完成后立即上传
+     */
+    shared_future<shared_ptr<SDL_Texture>> preload(SDL_Renderer *r, const string &path);
+
+    /**
+     * 主线程每帧调用：把已解码的图片上传为纹理，累计耗时超过 budgetMs 后留到下一次，返回本次上传的数量
+     */
+    int pumpUploads(double budgetMs);
+
+    /**
+     * 预加载进度（失败的也计入已完成）
+     */
+    int preloadDone() const { return preloadDone_; }
+    int preloadTotal() const { return preloadTotal_; }
+
     /**
-     * 获取纹理，同一对renderer、path只加载一次
+     * path 在图集页上的区域，不在清单中时返回 false
      */
-    shared_ptr<SDL_Texture> get(SDL_Renderer *r, const string &path);
+    bool regionOf(const string &path, SDL_Rect &out) const;
+
+    bool packed() const { return !regions_.empty(); }
 
     /**
      * renderer销毁前调用
@@ -28,8 +280,44 @@ public:
 
 private:
     TextureCache() = default;
+    ~TextureCache();
+
+    struct PendingLoad {
+        SDL_Renderer *renderer = nullptr;
+        TextureId id;
+        string path;
+        SDL_Surface *surface = nullptr; // 解码线程写入
+        string error;
+        bool decoded = false;
+        promise<shared_ptr<SDL_Texture>> done;
+        shared_future<shared_ptr<SDL_Texture>> future;
+    };
+
+    shared_ptr<SDL_Texture> upload(const shared_ptr<PendingLoad> &load);
+    void startDecoders();
+    void stopDecoders();
+    void decodeLoop();
 
-    unordered_map<string, weak_ptr<SDL_Texture>> cache_;
+    unordered_map<int, shared_ptr<PendingLoad>> pending_; // 按槽位索引，只在主线程访问
+    vector<shared_ptr<SDL_Texture>> preloaded_; // 预加载的纹理在 clear 前保持存活，避免还没人取用就被释放
+    int preloadDone_ = 0, preloadTotal_ = 0;
+
+    // 以下由 decodeMutex_ 保护
+    mutex decodeMutex_;
+    condition_variable decodeCv_;  // 有新的解码任务或需要退出
+    condition_variable decodedCv_; // 有图片解码完成
+    deque<shared_ptr<PendingLoad>> decodeQueue_;
+    deque<shared_ptr<PendingLoad>> uploadQueue_;
+    bool stopping_ = false;
+    vector<thread> decoders_;
+
+    struct Region {
+        string page; // 图集页图片路径
+        SDL_Rect rect;
+    };
+
+    AssetRegistry<TextureTag, TextureKey, SDL_Texture, TextureKeyHash> registry_;
+    unordered_map<string, Region> regions_;
 };
 
 class AtlasIndexCache {
@@ -37,9 +325,26 @@ public:
     static AtlasIndexCache &getInstance();
     
     /**
-     * 获取动画集
+     * 获取动画集，path 在图集清单中时帧坐标会加上其在图集页上的偏移
+     */
+    shared_ptr<const AtlasIndex> get(SDL_Texture *atlas, const string &path, int frameW, int frameH, int startX, int startY, int rows, int cols) {
+        return get(intern(path, frameW, frameH, startX, startY, rows, cols), atlas);
+    }
+
+    /**
+     * 获取编译期描述的动画集，直接引用 clip.frames，不再生成帧表
+     */
+    shared_ptr<const AtlasIndex> get(SDL_Texture *atlas, const string &path, const ClipDesc &clip) {
+        return get(intern(path, clip), atlas);
+    }
+
+    AtlasId intern(const string &path, int frameW, int frameH, int startX, int startY, int rows, int cols);
+    AtlasId intern(const string &path, const ClipDesc &clip);
+
+    /**
+     * 按句柄获取动画集；句柄已失效时返回空指针
      */
-    shared_ptr<const AtlasIndex> get(SDL_Texture *atlas, const string &path, int frameW, int frameH, int startX, int startY, int rows, int cols);
+    shared_ptr<const AtlasIndex> get(AtlasId id, SDL_Texture *atlas);
 
     /**
      * renderer销毁前调用
@@ -49,5 +354,5 @@ public:
 private:
     AtlasIndexCache() = default;
 
-    unordered_map<string, weak_ptr<const AtlasIndex>> cache_;
+    AssetRegistry<AtlasTag, AtlasKey, const AtlasIndex, AtlasKeyHash> registry_;
 };
\ No newline at end of file
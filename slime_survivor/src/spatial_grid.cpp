@@ -0,0 +1,71 @@
+#include "spatial_grid.h"
+
+SpatialGrid::SpatialGrid(int cellSize) {
+    if (cellSize <= 0) cellSize = DEFAULT_CELL_SIZE;
+    while ((1 << cellShift_) < cellSize) cellShift_++;
+}
+
+size_t SpatialGrid::bucketCountFor(size_t n) {
+    size_t buckets = 64;
+    while (buckets < n) buckets <<= 1;
+    return buckets;
+}
+
+void SpatialGrid::reserve(int n) {
+    pending_.reserve(n);
+    entries_.reserve(n);
+    bucketStart_.reserve(bucketCountFor(n) + 1);
+}
+
+void SpatialGrid::clear() {
+    pending_.clear();
+    entries_.clear();
+    maxHalfW_ = maxHalfH_ = 0;
+}
+
+void SpatialGrid::insert(int id, const SDL_Rect &rect) {
+    if (rect.w <= 0 || rect.h <= 0) return;
+    const int halfW = (rect.w + 1) / 2, halfH = (rect.h + 1) / 2;
+    if (halfW > maxHalfW_) maxHalfW_ = halfW;
+    if (halfH > maxHalfH_) maxHalfH_ = halfH;
+    pending_.push_back({id, cellCoord(rect.x + rect.w / 2), cellCoord(rect.y + rect.h / 2)});
+}
+
+void SpatialGrid::build() {
+    const size_t buckets = bucketCountFor(pending_.size());
+    bucketMask_ = buckets - 1;
+    bucketStart_.assign(buckets + 1, 0);
+
+    // 计数排序：先统计每个桶的数量，再前缀和，最后倒序回填
+    for (const Entry &e : pending_) {
+        bucketStart_[bucketOf(e.cx, e.cy) + 1]++;
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart_[b + 1] += bucketStart_[b];
+    }
+    entries_.resize(pending_.size());
+    for (const Entry &e : pending_) {
+        entries_[--bucketStart_[bucketOf(e.cx, e.cy) + 1]] = e;
+    }
+    // 回填后 bucketStart_[b+1] 退回到了桶 b 的起点，整体左移一位还原
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart_[b] = bucketStart_[b + 1];
+    }
+    bucketStart_[buckets] = (int)entries_.size();
+}
+
+void SpatialGrid::query(const SDL_Rect &rect, vector<int> &out) const {
+    out.clear();
+    if (entries_.empty() || rect.w <= 0 || rect.h <= 0) return;
+    const int cx0 = cellCoord(rect.x - maxHalfW_), cx1 = cellCoord(rect.x + rect.w - 1 + maxHalfW_);
+    const int cy0 = cellCoord(rect.y - maxHalfH_), cy1 = cellCoord(rect.y + rect.h - 1 + maxHalfH_);
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            const size_t b = bucketOf(cx, cy);
+            for (int e = bucketStart_[b]; e < bucketStart_[b + 1]; ++e) {
+                const Entry &en = entries_[e];
+                if (en.cx == cx && en.cy == cy) out.push_back(en.id); // 过滤哈希冲突
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+using namespace std;
+
+/**
+ * 均匀网格空间哈希，用于碰撞粗筛
+ * 每帧 clear -> insert -> build 重建一次，之后 query 只遍历矩形覆盖的格子
+ * 对象按中心点归入唯一格子（松散网格），查询时按登记过的最大半宽/半高外扩，因此结果无需去重
+ */
+class SpatialGrid {
+public:
+    static const int DEFAULT_CELL_SIZE = 64;
+
+    /**
+     * @param cellSize 格子边长，向上取整到2的幂，以便用移位计算格子坐标
+     */
+    explicit SpatialGrid(int cellSize = DEFAULT_CELL_SIZE);
+
+    /**
+     * 按对象数上限预分配内存，之后每帧重建不再触发堆分配
+     */
+    void reserve(int n);
+
+    /**
+     * 清空上一帧的数据（保留已分配的内存）
+     */
+    void clear();
+
+    /**
+     * 登记一个对象，id 通常就是对象在数组中的下标
+     */
+    void insert(int id, const SDL_Rect &rect);
+
+    /**
+     * 插入完毕后调用，把对象按格子归桶
+     */
+    void build();
+
+    /**
+     * 查询可能与 rect 相交的对象 id（只做粗筛，调用方仍需精确判断）
+     */
+    void query(const SDL_Rect &rect, vector<int> &out) const;
+
+    int cellSize() const { return 1 << cellShift_; }
+
+private:
+    struct Entry { int id; int cx, cy; };
+
+    static size_t bucketCountFor(size_t n); // 桶数取不小于对象数的2的幂
+    int cellCoord(int v) const { return v >> cellShift_; } // 算术右移，负坐标也向下取整
+    size_t bucketOf(int cx, int cy) const {
+        return (size_t(unsigned(cx) * 73856093u ^ unsigned(cy) * 19349663u)) & bucketMask_;
+    }
+
+    int cellShift_ = 0;
+    int maxHalfW_ = 0, maxHalfH_ = 0;
+    vector<Entry> pending_;
+    vector<Entry> entries_;
+    vector<int> bucketStart_; // 长度为桶数+1，桶数为2的幂
+    size_t bucketMask_ = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+using namespace std;
+
+/**
+ * 精灵批量渲染
+ * 同一纹理的四边形先收集起来，flush 时每个纹理只调用一次 SDL_RenderGeometry
+ * 一个批次内不同纹理按首次出现的顺序绘制，需要严格前后遮挡时在层与层之间调用 endLayer
+ */
+class SpriteBatch {
+public:
+    struct Stats {
+        int drawCalls = 0; // SDL_RenderGeometry 调用次数
+        int sprites = 0;   // 提交的四边形数
+    };
+
+    /**
+     * 开始收集，每帧渲染前调用
+     */
+    void begin(SDL_Renderer *r);
+
+    /**
+     * 提交一个轴对齐的精灵，效果等同于 SDL_RenderCopy
+     */
+    void draw(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst);
+
+    /**
+     * 提交一个绕 pivot（相对 dst 左上角）顺时针旋转 angleDeg 度的精灵，效果等同于 SDL_RenderCopyEx
+     */
+    void drawRotated(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst, double angleDeg, const SDL_Point &pivot);
+
+    /**
+     * 把已收集的精灵按纹理提交给渲染器
+     */
+    void flush();
+
+    /**
+     * 结束一层：批次里只有一种纹理时绘制顺序就是提交顺序，可以继续合并到下一层（例如所有精灵都来自同一张图集）；
+     * 有多种纹理时等同于 flush
+     */
+    void endLayer() { if (usedBuckets_ > 1) flush(); }
+
+    const Stats &stats() const { return stats_; }
+    void resetStats() { stats_ = Stats(); }
+
+private:
+    struct Bucket {
+        SDL_Texture *texture = nullptr;
+        float invW = 0, invH = 0; // 纹理宽高的倒数，用于计算 uv
+        vector<SDL_Vertex> vertices;
+    };
+
+    Bucket &bucketFor(SDL_Texture *tex);
+    void pushQuad(Bucket &b, const SDL_Rect &src, const SDL_FPoint corners[4]);
+
+    SDL_Renderer *renderer_ = nullptr;
+    vector<Bucket> buckets_; // flush 后保留，复用顶点内存
+    int usedBuckets_ = 0;
+    vector<int> indices_;    // 所有四边形共用的索引 0,1,2, 2,3,0, 4,5,6 ...
+    Stats stats_;
+};
@@ -0,0 +1,193 @@
+#include "steering.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define STEER_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STEER_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+void seekAndMoveScalar(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                       const float *flowX, const float *flowY,
+                       const uint8_t *moving, uint8_t *arrived, int n) {
+    for (int i = 0; i < n; ++i) {
+        arrived[i] = 0;
+        if (!moving[i]) {
+            vx[i] = vy[i] = 0;
+            continue;
+        }
+        // 与 Character::center() 一致，按取整后的中心计算
+        const float dx = p.targetX - float(int(x[i] + p.halfSize));
+        const float dy = p.targetY - float(int(y[i] + p.halfSize));
+        const float dist = sqrtf(dx * dx + dy * dy);
+        if (dist <= p.attackRange) {
+            vx[i] = vy[i] = 0;
+            arrived[i] = 1;
+            continue;
+        }
+        float ux = dx / dist, uy = dy / dist;
+        if (flowX && (flowX[i] != 0 || flowY[i] != 0)) {
+            ux = flowX[i];
+            uy = flowY[i];
+        }
+        vx[i] = ux * p.speed;
+        vy[i] = uy * p.speed;
+        float nx = x[i] + vx[i] * p.dt_ms / 1000.0f;
+        float ny = y[i] + vy[i] * p.dt_ms / 1000.0f;
+        if (nx < 0) nx = 0;
+        if (ny < 0) ny = 0;
+        if (nx > p.maxX) nx = p.maxX;
+        if (ny > p.maxY) ny = p.maxY;
+        x[i] = nx;
+        y[i] = ny;
+    }
+}
+
+#ifdef STEER_HAS_SSE2
+// 每次处理4个敌人，SSE2 没有 blendv，用与/或拼出选择
+static inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+template <bool kFlow>
+static void seekAndMoveSse2(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                            const float *flowX, const float *flowY,
+                            const uint8_t *moving, uint8_t *arrived, int n) {
+    const __m128 tx = _mm_set1_ps(p.targetX), ty = _mm_set1_ps(p.targetY);
+    const __m128 half = _mm_set1_ps(p.halfSize), speed = _mm_set1_ps(p.speed);
+    const __m128 dt = _mm_set1_ps(p.dt_ms), ms = _mm_set1_ps(1000.0f);
+    const __m128 range = _mm_set1_ps(p.attackRange);
+    const __m128 zero = _mm_setzero_ps(), maxX = _mm_set1_ps(p.maxX), maxY = _mm_set1_ps(p.maxY);
+    const __m128i zeroi = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+        const __m128 dx = _mm_sub_ps(tx, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(px, half))));
+        const __m128 dy = _mm_sub_ps(ty, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(py, half))));
+        const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        // 4 个字节的 moving 扩展成 4 个 32 位掩码
+        int32_t m4;
+        memcpy(&m4, moving + i, 4);
+        __m128i m = _mm_unpacklo_epi8(_mm_cvtsi32_si128(m4), zeroi);
+        m = _mm_unpacklo_epi16(m, zeroi);
+        const __m128 active = _mm_castsi128_ps(_mm_cmpgt_epi32(m, zeroi));
+        const __m128 inRange = _mm_cmple_ps(dist, range);
+        const __m128 arrive = _mm_and_ps(active, inRange);
+        const __m128 move = _mm_andnot_ps(inRange, active);
+        __m128 ux = _mm_div_ps(dx, dist), uy = _mm_div_ps(dy, dist);
+        if (kFlow) {
+            const __m128 fx = _mm_loadu_ps(flowX + i), fy = _mm_loadu_ps(flowY + i);
+            const __m128 hasFlow = _mm_or_ps(_mm_cmpneq_ps(fx, zero), _mm_cmpneq_ps(fy, zero));
+            ux = select4(hasFlow, fx, ux);
+            uy = select4(hasFlow, fy, uy);
+        }
+        const __m128 nvx = _mm_and_ps(move, _mm_mul_ps(ux, speed));
+        const __m128 nvy = _mm_and_ps(move, _mm_mul_ps(uy, speed));
+        __m128 nx = _mm_add_ps(px, _mm_div_ps(_mm_mul_ps(nvx, dt), ms));
+        __m128 ny = _mm_add_ps(py, _mm_div_ps(_mm_mul_ps(nvy, dt), ms));
+        nx = _mm_min_ps(_mm_max_ps(nx, zero), maxX);
+        ny = _mm_min_ps(_mm_max_ps(ny, zero), maxY);
+        _mm_storeu_ps(x + i, select4(move, nx, px));
+        _mm_storeu_ps(y + i, select4(move, ny, py));
+        _mm_storeu_ps(vx + i, nvx);
+        _mm_storeu_ps(vy + i, nvy);
+        const int bits = _mm_movemask_ps(arrive);
+        for (int k = 0; k < 4; ++k) arrived[i + k] = (bits >> k) & 1;
+    }
+    seekAndMoveScalar(p, x + i, y + i, vx + i, vy + i, kFlow ? flowX + i : nullptr, kFlow ? flowY + i : nullptr,
+                      moving + i, arrived + i, n - i);
+}
+
+static void seekAndMoveSse2(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                            const float *flowX, const float *flowY,
+                            const uint8_t *moving, uint8_t *arrived, int n) {
+    if (flowX) {
+        seekAndMoveSse2<true>(p, x, y, vx, vy, flowX, flowY, moving, arrived, n);
+    } else {
+        seekAndMoveSse2<false>(p, x, y, vx, vy, flowX, flowY, moving, arrived, n);
+    }
+}
+#endif
+
+#ifdef STEER_HAS_AVX2
+// 每次处理8个敌人；只开启 avx2 不开启 fma，保证乘加不会被合并，结果与标量一致
+template <bool kFlow>
+__attribute__((target("avx2")))
+static void seekAndMoveAvx2(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                            const float *flowX, const float *flowY,
+                            const uint8_t *moving, uint8_t *arrived, int n) {
+    const __m256 tx = _mm256_set1_ps(p.targetX), ty = _mm256_set1_ps(p.targetY);
+    const __m256 half = _mm256_set1_ps(p.halfSize), speed = _mm256_set1_ps(p.speed);
+    const __m256 dt = _mm256_set1_ps(p.dt_ms), ms = _mm256_set1_ps(1000.0f);
+    const __m256 range = _mm256_set1_ps(p.attackRange);
+    const __m256 zero = _mm256_setzero_ps(), maxX = _mm256_set1_ps(p.maxX), maxY = _mm256_set1_ps(p.maxY);
+    const __m256i zeroi = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+        const __m256 dx = _mm256_sub_ps(tx, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_add_ps(px, half))));
+        const __m256 dy = _mm256_sub_ps(ty, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_add_ps(py, half))));
+        const __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        // 8 个字节的 moving 扩展成 8 个 32 位掩码
+        const __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(moving + i)));
+        const __m256 active = _mm256_castsi256_ps(_mm256_cmpgt_epi32(m, zeroi));
+        const __m256 inRange = _mm256_cmp_ps(dist, range, _CMP_LE_OQ);
+        const __m256 arrive = _mm256_and_ps(active, inRange);
+        const __m256 move = _mm256_andnot_ps(inRange, active);
+        __m256 ux = _mm256_div_ps(dx, dist), uy = _mm256_div_ps(dy, dist);
+        if (kFlow) {
+            const __m256 fx = _mm256_loadu_ps(flowX + i), fy = _mm256_loadu_ps(flowY + i);
+            const __m256 hasFlow = _mm256_or_ps(_mm256_cmp_ps(fx, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(fy, zero, _CMP_NEQ_UQ));
+            ux = _mm256_blendv_ps(ux, fx, hasFlow);
+            uy = _mm256_blendv_ps(uy, fy, hasFlow);
+        }
+        const __m256 nvx = _mm256_and_ps(move, _mm256_mul_ps(ux, speed));
+        const __m256 nvy = _mm256_and_ps(move, _mm256_mul_ps(uy, speed));
+        __m256 nx = _mm256_add_ps(px, _mm256_div_ps(_mm256_mul_ps(nvx, dt), ms));
+        __m256 ny = _mm256_add_ps(py, _mm256_div_ps(_mm256_mul_ps(nvy, dt), ms));
+        nx = _mm256_min_ps(_mm256_max_ps(nx, zero), maxX);
+        ny = _mm256_min_ps(_mm256_max_ps(ny, zero), maxY);
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(px, nx, move));
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(py, ny, move));
+        _mm256_storeu_ps(vx + i, nvx);
+        _mm256_storeu_ps(vy + i, nvy);
+        const int bits = _mm256_movemask_ps(arrive);
+        for (int k = 0; k < 8; ++k) arrived[i + k] = (bits >> k) & 1;
+    }
+    seekAndMoveScalar(p, x + i, y + i, vx + i, vy + i, kFlow ? flowX + i : nullptr, kFlow ? flowY + i : nullptr,
+                      moving + i, arrived + i, n - i);
+}
+
+static void seekAndMoveAvx2(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                            const float *flowX, const float *flowY,
+                            const uint8_t *moving, uint8_t *arrived, int n) {
+    if (flowX) {
+        seekAndMoveAvx2<true>(p, x, y, vx, vy, flowX, flowY, moving, arrived, n);
+    } else {
+        seekAndMoveAvx2<false>(p, x, y, vx, vy, flowX, flowY, moving, arrived, n);
+    }
+}
+#endif
+
+vector<SeekKernel> availableSeekKernels() {
+    vector<SeekKernel> kernels;
+    kernels.push_back({"scalar", seekAndMoveScalar});
+#ifdef STEER_HAS_SSE2
+    kernels.push_back({"sse2", seekAndMoveSse2});
+#endif
+#ifdef STEER_HAS_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", seekAndMoveAvx2});
+    }
+#endif
+    return kernels;
+}
+
+const SeekKernel &bestSeekKernel() {
+    static const SeekKernel best = availableSeekKernels().back();
+    return best;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/**
+ * 追踪移动的参数，对一批敌人相同
+ */
+struct SeekParams {
+    float targetX = 0, targetY = 0; // 目标中心
+    float halfSize = 0;             // 位置 + halfSize 取整后作为敌人中心
+    float speed = 0;                // 像素/秒
+    float dt_ms = 0;
+    float attackRange = 0;          // 距离不超过它时视为到达，停下不动
+    float maxX = 0, maxY = 0;       // 位置夹在 [0, max] 内
+};
+
+/**
+ * 追踪移动内核：对 [0, n) 中 moving[i] 非0的敌人，计算朝向目标的单位方向、速度和位移并夹紧到屏幕内
+ * 到达攻击范围的敌人速度清零、位置不变，arrived[i] 置1；moving[i] 为0的敌人速度清零、位置不变
+ * flowX/flowY 不为空时，(flowX[i], flowY[i]) 非零的敌人改按该单位方向（流场方向）移动，攻击距离仍按目标计算
+ * 所有实现的结果与标量版本逐位一致
+ */
+typedef void (*SeekFn)(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                       const float *flowX, const float *flowY,
+                       const uint8_t *moving, uint8_t *arrived, int n);
+
+struct SeekKernel {
+    const char *name;
+    SeekFn fn;
+};
+
+/**
+ * 标量实现，作为其他实现的对照
+ */
+void seekAndMoveScalar(const SeekParams &p, float *x, float *y, float *vx, float *vy,
+                       const float *flowX, const float *flowY,
+                       const uint8_t *moving, uint8_t *arrived, int n);
+
+/**
+ * 当前 CPU 上可用的所有实现，标量版本在最前，最快的在最后
+ */
+vector<SeekKernel> availableSeekKernels();
+
+/**
+ * 当前 CPU 上最快的实现（AVX2 > SSE2 > 标量），首次调用时检测
+ */
+const SeekKernel &bestSeekKernel();
@@ -0,0 +1,19 @@
+#include "wave_spawner.h"
+
+int WaveSpawner::spawnWave(EnemySwarm &swarm, int n, const SDL_Rect &view) {
+    int spawned = 0;
+    while (spawned < n && !swarm.full()) {
+        SDL_Point pos = Character::randomSpawnOutsidePos(view, EnemySwarm::SIZE, EnemySwarm::SIZE, SPAWN_OFFSET);
+        swarm.spawn(pos.x, pos.y);
+        spawned++;
+    }
+    return spawned;
+}
+
+void WaveSpawner::update(float dt_ms, EnemySwarm &swarm, const SDL_Rect &view) {
+    timerMs_ += dt_ms;
+    if (timerMs_ < intervalMs_) return;
+    timerMs_ -= intervalMs_;
+    spawnWave(swarm, waveSize_ + growth_ * wave_, view);
+    wave_++;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "enemy_swarm.h"
+
+/**
+ * 敌人波次生成器
+ * 每隔固定时间在视口外生成一波敌人，波次规模逐波递增；敌人从对象池取槽位，池满时本波剩余的敌人不再生成
+ */
+class WaveSpawner {
+public:
+    static const int DEFAULT_INTERVAL_MS = 5000;
+    static const int DEFAULT_WAVE_SIZE = 10;
+    static const int DEFAULT_WAVE_GROWTH = 2;
+    static const int SPAWN_OFFSET = 100; // 生成点距视口边缘的距离
+
+    void setInterval(float ms) { intervalMs_ = ms; }
+    void setWaveSize(int size, int growth) { waveSize_ = size; growth_ = growth; }
+
+    /**
+     * 立即在视口（世界坐标）外生成 n 个敌人，返回实际生成的数量
+     */
+    int spawnWave(EnemySwarm &swarm, int n, const SDL_Rect &view);
+
+    /**
+     * 推进计时，到时间就在视口外生成下一波，每个模拟步调用
+     */
+    void update(float dt_ms, EnemySwarm &swarm, const SDL_Rect &view);
+
+    int wave() const { return wave_; }
+
+private:
+    float intervalMs_ = DEFAULT_INTERVAL_MS;
+    float timerMs_ = 0;
+    int waveSize_ = DEFAULT_WAVE_SIZE;
+    int growth_ = DEFAULT_WAVE_GROWTH;
+    int wave_ = 0;
+};
@@ -0,0 +1,76 @@
+#include "worker_pool.h"
+#include "profiler.h"
+
+void WorkerPool::start(int threads) {
+    stop();
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    stopping_ = false;
+    workers_.reserve(threads - 1);
+    const unsigned seq = jobSeq_;
+    for (int t = 1; t < threads; ++t) {
+        workers_.emplace_back([this, seq]() { workerLoop(seq); });
+    }
+}
+
+void WorkerPool::stop() {
+    if (workers_.empty()) return;
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeCv_.notify_all();
+    for (auto &w : workers_) {
+        w.join();
+    }
+    workers_.clear();
+}
+
+void WorkerPool::run(int chunks, ChunkFn fn, const void *ctx) {
+    if (chunks <= 0) return;
+    // 没有工作线程或只有一块时直接在调用线程上执行，省去唤醒开销
+    if (workers_.empty() || chunks == 1) {
+        for (int c = 0; c < chunks; ++c) {
+            fn(ctx, c);
+        }
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        fn_ = fn;
+        ctx_ = ctx;
+        chunks_ = chunks;
+        nextChunk_.store(0, memory_order_relaxed);
+        busyWorkers_ = (int)workers_.size();
+        jobSeq_++;
+    }
+    wakeCv_.notify_all();
+    drain();
+    // 必须等所有工作线程都确认过本次任务，返回后 ctx 才能安全失效
+    unique_lock<mutex> lock(mutex_);
+    doneCv_.wait(lock, [this]() { return busyWorkers_ == 0; });
+}
+
+void WorkerPool::drain() {
+    int c;
+    while ((c = nextChunk_.fetch_add(1, memory_order_relaxed)) < chunks_) {
+        fn_(ctx_, c);
+    }
+}
+
+void WorkerPool::workerLoop(unsigned seenSeq) {
+    Profiler::setThreadName("worker");
+    for (;;) {
+        {
+            unique_lock<mutex> lock(mutex_);
+            wakeCv_.wait(lock, [&]() { return stopping_ || jobSeq_ != seenSeq; });
+            if (stopping_) return;
+            seenSeq = jobSeq_;
+        }
+        drain();
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (--busyWorkers_ == 0) doneCv_.notify_one();
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/**
+ * 固定大小的工作线程池，用于按块并行处理数据
+ * 调用线程本身也参与干活，因此 N 个线程只会额外创建 N-1 个工作线程
+ * parallelFor 阻塞到所有块完成才返回；任务以函数指针 + 上下文传递，不产生堆分配
+ */
+class WorkerPool {
+public:
+    WorkerPool() = default;
+    ~WorkerPool() { stop(); }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+     * 启动线程池
+     * @param threads 总线程数（含调用线程），<= 0 时取硬件线程数
+     */
+    void start(int threads);
+
+    /**
+     * 通知所有工作线程退出并等待其结束
+     */
+    void stop();
+
+    /**
+     * 总线程数（含调用线程），未启动时为 1
+     */
+    int threadCount() const { return (int)workers_.size() + 1; }
+
+    /**
+     * 对 [0, chunks) 的每个块调用一次 f(chunk)，块之间的执行顺序和所在线程不确定
+     * f 只能写属于本块的数据，需要影响共享状态的操作应记录下来，等返回后在调用线程上按块顺序合并
+     */
+    template <class F>
+    void parallelFor(int chunks, const F &f) {
+        run(chunks, [](const void *ctx, int chunk) { (*static_cast<const F *>(ctx))(chunk); }, &f);
+    }
+
+private:
+    typedef void (*ChunkFn)(const void *ctx, int chunk);
+
+    void run(int chunks, ChunkFn fn, const void *ctx);
+    void drain();
+    void workerLoop(unsigned seenSeq);
+
+    vector<thread> workers_;
+    mutex mutex_;
+    condition_variable wakeCv_;
+    condition_variable doneCv_;
+    bool stopping_ = false;
+    unsigned jobSeq_ = 0; // 每发布一个任务加一，工作线程据此判断有无新任务
+    int busyWorkers_ = 0; // 尚未处理完当前任务的工作线程数
+
+    // 当前任务
+    ChunkFn fn_ = nullptr;
+    const void *ctx_ = nullptr;
+    int chunks_ = 0;
+    atomic<int> nextChunk_{0};
+};
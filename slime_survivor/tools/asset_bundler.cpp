@@ -0,0 +1,215 @@
+/**
+ * 资源包打包工具
+ * 把图片预先解码为 RGBA32 像素、把 WAV 转换为与音频设备一致的 PCM，连同其他文件原样写进一个资源包，
+ * 运行时由 AssetBundle mmap 后直接使用，启动时不再解码
+ *
+ * 用法（在游戏的工作目录下运行，使包里的路径与代码中的路径一致）：
+ *   slime_survivor/src:  ../tools/asset_bundler ../assets.bundle ../img/title_bg.png ../img/map.png ../img/bullets.png ../img/button.png
+ *                            ../img/hero/hero_*.png ../img/enemy/enemy_*.png ../aud/bgm_*.mp3 ../aud/hurt.wav
+ *                        （打包过图集时再加上 ../img/atlas/sprites.atlas ../img/atlas/sprites_0.png）
+ *   type_tag:            ../slime_survivor/tools/asset_bundler ./assets.bundle ./img/map.png ./img/numbers.png ./img/go.png
+ *                            ./img/btn_bg.png ./img/player?_*.png ./font/CozetteVector.ttf
+ *
+ * 选项：--freq 44100 --channels 2 指定 PCM 的采样率和声道数，需与游戏里 Mix_OpenAudio 的参数一致
+ * 文件格式见 src/asset_bundle.h
+ */
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/asset_bundle.h"
+using namespace std;
+
+struct Item {
+    BundleEntry entry{};
+    string name;
+    vector<Uint8> data;
+};
+
+static void usage() {
+    printf("用法: asset_bundler [--freq N] [--channels N] <输出资源包> <文件>...\n");
+}
+
+static string extensionOf(const string &path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == string::npos || path.find_first_of("/\\", dot) != string::npos) return "";
+    string ext = path.substr(dot + 1);
+    for (auto &c : ext) c = (char)tolower((unsigned char)c);
+    return ext;
+}
+
+static bool packImage(Item &item) {
+    SDL_Surface *raw = IMG_Load(item.name.c_str());
+    if (!raw) {
+        printf("SDL Load Image Error: %s\n", IMG_GetError());
+        return false;
+    }
+    SDL_Surface *surf = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(raw);
+    if (!surf) {
+        printf("SDL Convert Surface Error: %s\n", SDL_GetError());
+        return false;
+    }
+    // 按行紧凑存放，去掉表面自带的行尾填充
+    const int pitch = surf->w * 4;
+    item.data.resize((size_t)pitch * surf->h);
+    for (int y = 0; y < surf->h; ++y) {
+        memcpy(&item.data[(size_t)y * pitch], (const Uint8 *)surf->pixels + (size_t)y * surf->pitch, pitch);
+    }
+    item.entry.kind = BUNDLE_IMAGE;
+    item.entry.param[0] = surf->w;
+    item.entry.param[1] = surf->h;
+    item.entry.param[2] = pitch;
+    SDL_FreeSurface(surf);
+    return true;
+}
+
+static bool packPcm(Item &item, int freq, int channels) {
+    SDL_AudioSpec spec;
+    Uint8 *buf = nullptr;
+    Uint32 len = 0;
+    if (!SDL_LoadWAV(item.name.c_str(), &spec, &buf, &len)) {
+        printf("SDL Load WAV Error: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_S16SYS, (Uint8)channels, freq) < 0) {
+        printf("SDL Build Audio CVT Error: %s\n", SDL_GetError());
+        SDL_FreeWAV(buf);
+        return false;
+    }
+    item.data.resize((size_t)len * max(cvt.len_mult, 1));
+    memcpy(item.data.data(), buf, len);
+    SDL_FreeWAV(buf);
+    cvt.buf = item.data.data();
+    cvt.len = (int)len;
+    if (cvt.needed && SDL_ConvertAudio(&cvt) < 0) {
+        printf("SDL Convert Audio Error: %s\n", SDL_GetError());
+        return false;
+    }
+    item.data.resize(cvt.needed ? (size_t)cvt.len_cvt : len);
+    item.entry.kind = BUNDLE_PCM;
+    item.entry.param[0] = freq;
+    item.entry.param[1] = AUDIO_S16SYS;
+    item.entry.param[2] = channels;
+    return true;
+}
+
+static bool packRaw(Item &item) {
+    FILE *f = fopen(item.name.c_str(), "rb");
+    if (!f) {
+        printf("无法读取 %s\n", item.name.c_str());
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    item.data.resize(size > 0 ? (size_t)size : 0);
+    const bool ok = item.data.empty() || fread(item.data.data(), 1, item.data.size(), f) == item.data.size();
+    fclose(f);
+    if (!ok) printf("读取 %s 失败\n", item.name.c_str());
+    item.entry.kind = BUNDLE_RAW;
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int freq = 44100, channels = 2;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] == '-'; argi += 2) {
+        const string opt = argv[argi];
+        if (argi + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (opt == "--freq") {
+            freq = atoi(argv[argi + 1]);
+        } else if (opt == "--channels") {
+            channels = atoi(argv[argi + 1]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (argc - argi < 2 || freq <= 0 || channels <= 0 || channels > 8) {
+        usage();
+        return 1;
+    }
+    const string bundlePath = argv[argi++];
+
+    const int imgFlags = IMG_INIT_PNG | IMG_INIT_JPG;
+    if ((IMG_Init(imgFlags) & IMG_INIT_PNG) == 0) {
+        printf("SDL Image Init Error: %s\n", IMG_GetError());
+        return 1;
+    }
+    vector<Item> items;
+    for (; argi < argc; ++argi) {
+        Item item;
+        item.name = argv[argi];
+        const string ext = extensionOf(item.name);
+        bool ok;
+        if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp") {
+            ok = packImage(item);
+        } else if (ext == "wav") {
+            ok = packPcm(item, freq, channels);
+        } else {
+            ok = packRaw(item); // 音乐、字体、图集清单等原样存放
+        }
+        if (!ok) {
+            IMG_Quit();
+            return 1;
+        }
+        items.push_back(move(item));
+    }
+    IMG_Quit();
+
+    // 布局：头部、条目表、路径字符串区，之后每块数据按 BUNDLE_ALIGN 对齐
+    string names;
+    for (auto &item : items) {
+        item.entry.nameOffset = (Uint32)names.size();
+        item.entry.nameLength = (Uint32)item.name.size();
+        names += item.name;
+    }
+    BundleHeader header;
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+    header.version = BUNDLE_VERSION;
+    header.count = (Uint32)items.size();
+    header.namesSize = (Uint32)names.size();
+    Uint64 offset = sizeof(header) + items.size() * sizeof(BundleEntry) + names.size();
+    for (auto &item : items) {
+        offset = (offset + BUNDLE_ALIGN - 1) / BUNDLE_ALIGN * BUNDLE_ALIGN;
+        item.entry.offset = offset;
+        item.entry.size = item.data.size();
+        offset += item.data.size();
+    }
+
+    FILE *out = fopen(bundlePath.c_str(), "wb");
+    if (!out) {
+        printf("无法写入资源包 %s\n", bundlePath.c_str());
+        return 1;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (auto &item : items) {
+        ok = ok && fwrite(&item.entry, sizeof(item.entry), 1, out) == 1;
+    }
+    ok = ok && fwrite(names.data(), 1, names.size(), out) == names.size();
+    static const Uint8 zeros[BUNDLE_ALIGN] = {};
+    for (auto &item : items) {
+        const long pad = (long)item.entry.offset - ftell(out);
+        ok = ok && fwrite(zeros, 1, (size_t)pad, out) == (size_t)pad;
+        ok = ok && fwrite(item.data.data(), 1, item.data.size(), out) == item.data.size();
+        const char *kind = item.entry.kind == BUNDLE_IMAGE ? "image" : item.entry.kind == BUNDLE_PCM ? "pcm" : "raw";
+        printf("%-5s %8zu bytes  %s\n", kind, item.data.size(), item.name.c_str());
+    }
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        printf("写入资源包 %s 失败\n", bundlePath.c_str());
+        return 1;
+    }
+    printf("bundled %zu files, %.1f MB: %s\n", items.size(), offset / (1024.0 * 1024.0), bundlePath.c_str());
+    return 0;
+}
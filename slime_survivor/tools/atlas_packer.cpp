@@ -0,0 +1,185 @@
+/**
+ * 离线图集打包工具
+ * 把多张精灵图打包进一张或几张图集页，并生成记录每张图所在区域的清单，供 TextureCache::loadManifest 使用
+ *
+ * 用法（在 slime_survivor/src 目录下运行，使清单里的路径与代码中的路径一致）：
+ *   ../tools/atlas_packer [--max 2048] [--padding 2] ../img/atlas/sprites.atlas ../img/hero/hero_*.png ../img/enemy/enemy_*.png ../img/bullets.png ../img/button.png
+ *
+ * 清单格式（文本，每行一条）：
+ *   page <图集页文件名，相对清单所在目录>
+ *   sprite <原图路径> <页号> <x> <y> <w> <h>
+ */
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+struct Sprite {
+    string path;
+    SDL_Surface *surface = nullptr;
+    int page = -1;
+    SDL_Rect rect{};
+};
+
+/**
+ * 货架式装箱：每页由若干行（货架）组成，图片按高度从大到小依次放进第一个放得下的货架
+ */
+struct Shelf {
+    int y, h, x;
+};
+
+struct Page {
+    vector<Shelf> shelves;
+    int usedW = 0, usedH = 0;
+};
+
+static bool placeOnPage(Page &page, int w, int h, int maxSize, SDL_Point &out) {
+    for (auto &shelf : page.shelves) {
+        if (h <= shelf.h && shelf.x + w <= maxSize) {
+            out = {shelf.x, shelf.y};
+            shelf.x += w;
+            page.usedW = max(page.usedW, shelf.x);
+            return true;
+        }
+    }
+    const int y = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().h;
+    if (y + h > maxSize || w > maxSize) return false;
+    page.shelves.push_back({y, h, w});
+    page.usedW = max(page.usedW, w);
+    page.usedH = y + h;
+    out = {0, y};
+    return true;
+}
+
+static void usage() {
+    printf("用法: atlas_packer [--max N] [--padding N] <输出清单.atlas> <图片>...\n");
+}
+
+int main(int argc, char *argv[]) {
+    int maxSize = 2048;
+    int padding = 2; // 图与图之间留空，避免缩放采样时串色
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] == '-'; argi += 2) {
+        const string opt = argv[argi];
+        if (argi + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (opt == "--max") {
+            maxSize = atoi(argv[argi + 1]);
+        } else if (opt == "--padding") {
+            padding = atoi(argv[argi + 1]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (argc - argi < 2 || maxSize <= 0 || padding < 0) {
+        usage();
+        return 1;
+    }
+    const string manifestPath = argv[argi++];
+
+    if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0) {
+        printf("SDL Image Init Error: %s\n", IMG_GetError());
+        return 1;
+    }
+    vector<Sprite> sprites;
+    for (; argi < argc; ++argi) {
+        Sprite sp;
+        sp.path = argv[argi];
+        SDL_Surface *raw = IMG_Load(sp.path.c_str());
+        if (!raw) {
+            printf("SDL Load Image Error: %s\n", IMG_GetError());
+            return 1;
+        }
+        sp.surface = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(raw);
+        if (!sp.surface) {
+            printf("SDL Convert Surface Error: %s\n", SDL_GetError());
+            return 1;
+        }
+        sp.rect.w = sp.surface->w;
+        sp.rect.h = sp.surface->h;
+        sprites.push_back(sp);
+    }
+
+    // 高的先放，同高时宽的先放，货架利用率更高
+    vector<Sprite *> order;
+    for (auto &sp : sprites) order.push_back(&sp);
+    stable_sort(order.begin(), order.end(), [](const Sprite *a, const Sprite *b) {
+        return a->rect.h != b->rect.h ? a->rect.h > b->rect.h : a->rect.w > b->rect.w;
+    });
+    vector<Page> pages;
+    for (Sprite *sp : order) {
+        const int w = sp->rect.w + padding, h = sp->rect.h + padding;
+        SDL_Point pos;
+        bool placed = false;
+        for (size_t p = 0; p < pages.size() && !placed; ++p) {
+            if (placeOnPage(pages[p], w, h, maxSize, pos)) {
+                sp->page = (int)p;
+                placed = true;
+            }
+        }
+        if (!placed) {
+            pages.emplace_back();
+            if (!placeOnPage(pages.back(), w, h, maxSize, pos)) {
+                printf("图片 %s (%dx%d) 超出图集页上限 %d\n", sp->path.c_str(), sp->rect.w, sp->rect.h, maxSize);
+                return 1;
+            }
+            sp->page = (int)pages.size() - 1;
+        }
+        sp->rect.x = pos.x;
+        sp->rect.y = pos.y;
+    }
+
+    // 图集页与清单放在同一目录，文件名为 <清单名>_<页号>.png
+    const size_t slash = manifestPath.find_last_of("/\\");
+    const string dir = slash == string::npos ? "" : manifestPath.substr(0, slash + 1);
+    string stem = manifestPath.substr(dir.size());
+    const size_t dot = stem.find_last_of('.');
+    if (dot != string::npos) stem = stem.substr(0, dot);
+    FILE *manifest = fopen(manifestPath.c_str(), "w");
+    if (!manifest) {
+        printf("无法写入清单 %s\n", manifestPath.c_str());
+        return 1;
+    }
+    fprintf(manifest, "# atlas manifest, generated by atlas_packer\n");
+    int result = 0;
+    for (size_t p = 0; p < pages.size() && result == 0; ++p) {
+        const string pageFile = stem + "_" + to_string(p) + ".png";
+        SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, pages[p].usedW, pages[p].usedH, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!page) {
+            printf("SDL Create Surface Error: %s\n", SDL_GetError());
+            result = 1;
+            break;
+        }
+        SDL_FillRect(page, nullptr, 0);
+        for (auto &sp : sprites) {
+            if (sp.page != (int)p) continue;
+            // 按原样拷贝像素（包括 alpha），不做混合
+            SDL_SetSurfaceBlendMode(sp.surface, SDL_BLENDMODE_NONE);
+            SDL_Rect dst = sp.rect;
+            SDL_BlitSurface(sp.surface, nullptr, page, &dst);
+        }
+        if (IMG_SavePNG(page, (dir + pageFile).c_str()) != 0) {
+            printf("SDL Save Image Error: %s\n", IMG_GetError());
+            result = 1;
+        }
+        SDL_FreeSurface(page);
+        fprintf(manifest, "page %s\n", pageFile.c_str());
+        printf("page %zu: %s %dx%d\n", p, pageFile.c_str(), pages[p].usedW, pages[p].usedH);
+    }
+    for (auto &sp : sprites) {
+        fprintf(manifest, "sprite %s %d %d %d %d %d\n", sp.path.c_str(), sp.page, sp.rect.x, sp.rect.y, sp.rect.w, sp.rect.h);
+        SDL_FreeSurface(sp.surface);
+    }
+    fclose(manifest);
+    IMG_Quit();
+    if (result == 0) printf("packed %zu images into %zu page(s): %s\n", sprites.size(), pages.size(), manifestPath.c_str());
+    return result;
+}
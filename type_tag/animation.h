@@ -4,6 +4,7 @@
 #include "vector2.h"
 #include "resource_cache.h"
 #include "camera.h"
+#include "sprite_batch.h"
 
 #include <vector>
 #include <functional>
@@ -14,8 +15,8 @@ public:
         timer.setOneShot(false);
         timer.setOnTimeout([&]() {
             idxFrame++;
-            if (idxFrame >= atlasIndex->frames.size()) {
-                idxFrame = isLoop? 0 : atlasIndex->frames.size() - 1;
+            if (idxFrame >= (size_t)atlasIndex->cols) {
+                idxFrame = isLoop? 0 : atlasIndex->cols - 1;
                 if (!isLoop && onFinished) {
                     onFinished();
                 }
@@ -47,13 +48,19 @@ public:
         dstRect.w = frameW;
         dstRect.h = frameH;
     }
+    void setAtlas(SDL_Renderer *renderer, const string &path, const ClipDesc &clip) {
+        texture = TextureCache::getInstance().get(renderer, path);
+        atlasIndex = AtlasIndexCache::getInstance().get(texture.get(), path, clip);
+        dstRect.w = clip.frameW;
+        dstRect.h = clip.frameH;
+    }
     void onUpdate(float deltaTime) {
         timer.onUpdate(deltaTime);
     }
-    void onRender(SDL_Renderer *renderer, const Camera& camera) {
+    void onRender(SpriteBatch& batch, const Camera& camera) {
         dstRect.x = position.x - camera.getPosition().x;
         dstRect.y = position.y - camera.getPosition().y;
-        SDL_RenderCopy(renderer, texture.get(), &atlasIndex->frames[rowFrame][idxFrame], &dstRect);
+        batch.draw(texture.get(), atlasIndex->frame(rowFrame, idxFrame), dstRect);
     }
 private:
     Timer timer;
@@ -0,0 +1,90 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+/**
+ * 资源包文件格式（小端，由 tools/asset_bundler 生成）：
+ *   BundleHeader | BundleEntry[count] | 路径字符串区 | 各资源数据（按 BUNDLE_ALIGN 对齐）
+ * 图片预先解码为 RGBA32 像素，WAV 预先转换为 PCM，其余文件（音乐、字体、图集清单等）原样存放
+ */
+static const char BUNDLE_MAGIC[4] = {'C', 'G', 'A', 'B'};
+static const Uint32 BUNDLE_VERSION = 1;
+static const Uint32 BUNDLE_ALIGN = 64;
+
+enum BundleKind : Uint32 {
+    BUNDLE_IMAGE = 1, // param = {w, h, pitch}，像素格式 SDL_PIXELFORMAT_RGBA32
+    BUNDLE_PCM = 2,   // param = {freq, format, channels}
+    BUNDLE_RAW = 3,   // 原始文件内容
+};
+
+struct BundleHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 count;     // 条目数
+    Uint32 namesSize; // 路径字符串区字节数
+};
+
+struct BundleEntry {
+    Uint32 kind;
+    Uint32 nameOffset; // 相对路径字符串区起点
+    Uint32 nameLength;
+    Uint32 param[3];
+    Uint64 offset;     // 相对文件起点
+    Uint64 size;
+};
+
+struct BundleImage {
+    const void *pixels;
+    int w, h, pitch;
+};
+
+struct BundlePcm {
+    const Uint8 *data;
+    Uint32 size;
+    int freq;
+    Uint16 format;
+    int channels;
+};
+
+/**
+ * 只读资源包：整个文件 mmap 进内存，图片像素和 PCM 直接指向映射区，不解码也不拷贝
+ * 包不存在时所有查询都返回 false，调用方退回到逐个加载散文件
+ */
+class AssetBundle {
+public:
+    static AssetBundle &getInstance();
+
+    /**
+     * 映射资源包并建立路径索引，文件不存在或格式不对时返回 false
+     */
+    bool open(const string &path);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    bool image(const string &path, BundleImage &out) const;
+    bool pcm(const string &path, BundlePcm &out) const;
+    bool raw(const string &path, const Uint8 *&data, size_t &size) const;
+
+    /**
+     * 以 RWops 形式读取原样存放的文件（供 Mix_LoadMUS_RW、TTF_OpenFontRW 等使用），不在包中时返回 nullptr
+     */
+    SDL_RWops *openRW(const string &path) const;
+
+    /**
+     * 映射的字节数
+     */
+    size_t mappedSize() const { return size_; }
+
+private:
+    AssetBundle() = default;
+    ~AssetBundle();
+
+    const BundleEntry *find(const string &path, Uint32 kind) const;
+
+    const Uint8 *base_ = nullptr;
+    size_t size_ = 0;
+    void *mapping_ = nullptr; // Windows 下的文件映射句柄
+    unordered_map<string, const BundleEntry *> index_;
+};
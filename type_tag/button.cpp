@@ -7,7 +7,7 @@ const char* Button::BTN_BG = "./img/btn_bg.png";
 bool Button::init(SDL_Renderer *r, shared_ptr<SDL_Texture> t, int x, int y, int tw, int th) {
     atlas_.texTxt = t;
     atlas_.texture = TextureCache::getInstance().get(r, BTN_BG);
-    atlas_.atlasIndex = AtlasIndexCache::getInstance().get(atlas_.texture.get(), BTN_BG, FRAME_W, FRAME_H, 0, 0, 1, FRAME_NUM);
+    atlas_.atlasIndex = AtlasIndexCache::getInstance().get(atlas_.texture.get(), BTN_BG, ClipGrid<FRAME_W, FRAME_H, 0, 0, 1, FRAME_NUM>::DESC);
     dstRect_.x = x;
     dstRect_.y = y;
     dstRect_.w = FRAME_W * 2;
@@ -57,6 +57,6 @@ void Button::handleMouseInput(const SDL_Event& e) {
 }
 
 void Button::render(SDL_Renderer *r) {
-    SDL_RenderCopy(r, atlas_.texture.get(), &atlas_.atlasIndex->frames[0][static_cast<int>(state_)], &dstRect_);
+    SDL_RenderCopy(r, atlas_.texture.get(), &atlas_.atlasIndex->frame(0, static_cast<int>(state_)), &dstRect_);
     SDL_RenderCopy(r, atlas_.texTxt.get(), nullptr, &txtRect_);
 }
\ No newline at end of file
@@ -1,60 +1,203 @@
 #pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <sstream>
+#include <string_view>
 #include <vector>
 using namespace std;
 
+/**
+ * 二进制编码（HTTP /progress 的请求和响应使用），所有整数为小端：
+ *   PlayerDto   [0] 版本  [1] DtoKind::Player      [2..5] id  [6..9] progress
+ *   进度列表    [0] 版本  [1] DtoKind::Progresses  [2..5] 玩家数 n  之后 n 个进度，每个 4 字节，下标即玩家 id
+ * 编码写入调用方提供的缓冲，解码直接读 string_view，都不分配内存；
+ * 解码检查版本、类型和长度，任何一项不符都返回 false 且不改动输出
+ */
+static const uint8_t DTO_VERSION = 1;
+static const int DTO_HEADER_SIZE = 2;
+static const int PLAYER_DTO_SIZE = DTO_HEADER_SIZE + 8;
+static const int PROGRESSES_HEADER_SIZE = DTO_HEADER_SIZE + 4;
+static const uint32_t DTO_MAX_PLAYERS = 1 << 16; // 解码时接受的玩家数上限
+static const char *const DTO_CONTENT_TYPE = "application/octet-stream";
+
+enum class DtoKind : uint8_t { Player = 1, Progresses = 2 };
+
+inline void putLe32(uint8_t *out, uint32_t v) {
+    out[0] = (uint8_t)(v & 0xFF);
+    out[1] = (uint8_t)((v >> 8) & 0xFF);
+    out[2] = (uint8_t)((v >> 16) & 0xFF);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+inline uint32_t getLe32(const char *in) {
+    const uint8_t *b = (const uint8_t *)in;
+    return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+inline bool checkDtoHeader(string_view in, DtoKind kind) {
+    return in.size() >= (size_t)DTO_HEADER_SIZE && (uint8_t)in[0] == DTO_VERSION && (uint8_t)in[1] == (uint8_t)kind;
+}
+
 struct PlayerDto {
     int id;
     int progress;
-    
-    // 序列化方法：将Player转换为字符串
-    string serialize() const {
-        ostringstream oss;
-        oss << id << " " << progress;
-        return oss.str();
+
+    /**
+     * 编码到 out，返回写入的字节数；cap 不足 PLAYER_DTO_SIZE 时返回 0
+     */
+    size_t encode(uint8_t *out, size_t cap) const {
+        if (cap < (size_t)PLAYER_DTO_SIZE) return 0;
+        out[0] = DTO_VERSION;
+        out[1] = (uint8_t)DtoKind::Player;
+        putLe32(out + 2, (uint32_t)id);
+        putLe32(out + 6, (uint32_t)progress);
+        return PLAYER_DTO_SIZE;
     }
-    
-    // 反序列化方法：从字符串恢复Player
-    static PlayerDto deserialize(const string& data) {
-        PlayerDto player;
-        istringstream iss(data);
-        iss >> player.id >> player.progress;
-        return player;
+
+    static bool decode(string_view in, PlayerDto &out) {
+        if (in.size() != (size_t)PLAYER_DTO_SIZE || !checkDtoHeader(in, DtoKind::Player)) return false;
+        out.id = (int)getLe32(in.data() + 2);
+        out.progress = (int)getLe32(in.data() + 6);
+        return true;
     }
+
 };
 
-// 序列化整个玩家列表（vector格式）
-inline string serializeProgresses(const vector<int>& progresses) {
-    ostringstream oss;
-    oss << progresses.size() << " ";
-    for (size_t i = 0; i < progresses.size(); ++i) {
-        oss << i << " " << progresses[i];
-        if (i < progresses.size() - 1) {
-            oss << ";";
+inline size_t encodedProgressesSize(size_t count) {
+    return PROGRESSES_HEADER_SIZE + count * 4;
+}
+
+/**
+ * 把 count 个进度编码到 out，返回写入的字节数；cap 不足 encodedProgressesSize(count) 时返回 0
+ */
+inline size_t encodeProgresses(const int *progresses, size_t count, uint8_t *out, size_t cap) {
+    const size_t size = encodedProgressesSize(count);
+    if (count > DTO_MAX_PLAYERS || cap < size) return 0;
+    out[0] = DTO_VERSION;
+    out[1] = (uint8_t)DtoKind::Progresses;
+    putLe32(out + 2, (uint32_t)count);
+    for (size_t i = 0; i < count; ++i) {
+        putLe32(out + PROGRESSES_HEADER_SIZE + i * 4, (uint32_t)progresses[i]);
+    }
+    return size;
+}
+
+/**
+ * 读出进度列表的玩家数，并检查数据长度与之相符
+ */
+inline bool decodeProgressesCount(string_view in, size_t &count) {
+    if (in.size() < (size_t)PROGRESSES_HEADER_SIZE || !checkDtoHeader(in, DtoKind::Progresses)) return false;
+    const uint32_t n = getLe32(in.data() + 2);
+    if (n > DTO_MAX_PLAYERS || in.size() != encodedProgressesSize(n)) return false;
+    count = n;
+    return true;
+}
+
+/**
+ * 解码到 out[0..cap)，成功时 count 为玩家数；玩家数超过 cap 时返回 false
+ */
+inline bool decodeProgresses(string_view in, int *out, size_t cap, size_t &count) {
+    size_t n;
+    if (!decodeProgressesCount(in, n) || n > cap) return false;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = (int)getLe32(in.data() + PROGRESSES_HEADER_SIZE + i * 4);
+    }
+    count = n;
+    return true;
+}
+
+/**
+ * 解码到 vector，复用它已有的容量（玩家数不增加时不分配）
+ */
+inline bool decodeProgresses(string_view in, vector<int> &out) {
+    size_t n;
+    if (!decodeProgressesCount(in, n)) return false;
+    out.resize(n);
+    return decodeProgresses(in, out.data(), n, n);
+}
+
+// 房间：除 POST /rooms 外的请求用 X-Room 头指定房间 id，没有这个头时进入默认房间（主机自己开的那一局）
+static const char *const ROOM_HEADER = "X-Room";
+static const int DEFAULT_ROOM = 0;
+
+// GET /events 推送：每条事件为 "data: " + 文本格式的快照 + 空行
+static const int EVENTS_TICK_MS = 16;    // 两次推送的最小间隔，期间的变化合并为一个快照
+static const int EVENTS_PING_MS = 1000;  // 进度没有变化时发注释行保活，顺便发现已断开的连接
+
+/**
+ * 文本格式的进度列表：SSE 只能传文本，GET /events 仍用它
+ *   "n id progress;id progress;..."，n 为玩家数，之后每个玩家一项，id 为下标
+ * 与二进制格式一样写入调用方提供的缓冲、直接读 string_view，不分配内存（解码到 vector 时复用已有容量）
+ */
+static const int INT_TEXT_MAX = 11; // int 的十进制表示最多 11 个字符（含负号）
+
+/**
+ * count 个进度编码成文本后的长度上限
+ */
+inline size_t maxProgressesTextSize(size_t count) {
+    return INT_TEXT_MAX + 1 + count * (INT_TEXT_MAX * 2 + 2);
+}
+
+/**
+ * 把 count 个进度按文本格式写到 out，返回写入的字节数；cap 不够时返回 0
+ */
+inline size_t formatProgresses(const int *progresses, size_t count, char *out, size_t cap) {
+    if (count > DTO_MAX_PLAYERS) return 0;
+    char *p = out, *const end = out + cap;
+    to_chars_result r = to_chars(p, end, count);
+    if (r.ec != errc() || r.ptr == end) return 0;
+    p = r.ptr;
+    *p++ = ' ';
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            if (p == end) return 0;
+            *p++ = ';';
         }
+        r = to_chars(p, end, i);
+        if (r.ec != errc() || r.ptr == end) return 0;
+        p = r.ptr;
+        *p++ = ' ';
+        r = to_chars(p, end, progresses[i]);
+        if (r.ec != errc()) return 0;
+        p = r.ptr;
     }
-    return oss.str();
-}
-
-// 反序列化玩家列表到vector
-inline vector<int> deserializeProgresses(const string& data) {
-    vector<int> result;
-    istringstream ss(data);
-    string playerData;
-    size_t size;
-    ss >> size;
-    result.resize(size);
-    
-    // 按分号分割每个玩家的数据
-    while (getline(ss, playerData, ';')) {
-        stringstream playerSs(playerData);
-        int id, process;
-        playerSs >> id >> process;
-        if (id >= size) {
-            continue;
+    return p - out;
+}
+
+/**
+ * 逐项读取文本格式的进度列表，out 为空时只检查格式；玩家数超过 DTO_MAX_PLAYERS、id 越界或格式不符时返回 false
+ */
+inline bool scanProgresses(string_view in, size_t &count, int *out) {
+    const char *p = in.data(), *const end = in.data() + in.size();
+    uint32_t n;
+    from_chars_result r = from_chars(p, end, n);
+    if (r.ec != errc() || n > DTO_MAX_PLAYERS || r.ptr == end || *r.ptr != ' ') return false;
+    p = r.ptr + 1;
+    while (p != end) {
+        uint32_t id;
+        int progress;
+        r = from_chars(p, end, id);
+        if (r.ec != errc() || id >= n || r.ptr == end || *r.ptr != ' ') return false;
+        r = from_chars(r.ptr + 1, end, progress);
+        if (r.ec != errc()) return false;
+        if (out) out[id] = progress;
+        p = r.ptr;
+        if (p != end) {
+            if (*p != ';' || p + 1 == end) return false;
+            ++p;
         }
-        result[id] = process;
     }
-    return result;
-}
\ No newline at end of file
+    count = n;
+    return true;
+}
+
+/**
+ * 解码文本格式到 vector，复用它已有的容量，没有出现的玩家进度为 0；失败时不改动 out
+ */
+inline bool parseProgresses(string_view in, vector<int> &out) {
+    size_t n;
+    if (!scanProgresses(in, n, nullptr)) return false;
+    out.assign(n, 0);
+    return scanProgresses(in, n, out.data());
+}
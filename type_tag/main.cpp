@@ -8,6 +8,9 @@
 #include "network_server.h"
 #include "network_client.h"
 #include "network_udp.h"
+#include "sprite_batch.h"
+#include "asset_bundle.h"
+#include "profiler.h"
 
 #include <chrono>
 #include <string>
@@ -34,6 +37,7 @@ static const string PATH_PLAYERS[4][2] = {
     {"./img/player4_idle.png", "./img/player4_walk.png"}
 };
 static const string PATH_FONT = "./font/CozetteVector.ttf";
+static const string PATH_BUNDLE = "./assets.bundle"; // tools/asset_bundler 生成，可缺省
 static const Vector2 START_POS(320.0f, 320.0f);
 
 bool running = true;
@@ -70,6 +74,7 @@ Button btnClient;
 Button btnStart;
 vector<Button> serverButtons;
 TTF_Font* font = nullptr;
+SpriteBatch spriteBatch;
 
 string strAddrServ = "localhost";
 int portServ = 25565;
@@ -87,9 +92,11 @@ void showMessageBox(const string& title, const string& message) {
 }
 
 void cleanup() {
-    if (texBG) SDL_DestroyTexture(texBG.get());
-    if (texNumbers) SDL_DestroyTexture(texNumbers.get());
-    if (texGO) SDL_DestroyTexture(texGO.get());
+    // 纹理归缓存所有，释放引用后统一由缓存在渲染器销毁前释放
+    texBG.reset();
+    texNumbers.reset();
+    texGO.reset();
+    TextureCache::getInstance().clear();
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
     TTF_Quit();
@@ -103,12 +110,21 @@ void connectToServer(const HostAnnounce& server);
 void connectServer();
 
 void loadResources(SDL_Renderer* renderer) {
-    font = TTF_OpenFont(PATH_FONT.c_str(), 24);
+    // 有资源包时字体直接从映射区读取
+    SDL_RWops *fontRW = AssetBundle::getInstance().openRW(PATH_FONT);
+    font = fontRW ? TTF_OpenFontRW(fontRW, 1, 24) : TTF_OpenFont(PATH_FONT.c_str(), 24);
     if (!font) {
         SDL_Log("SDL TTFOpenFont Error: %s", TTF_GetError());
         cleanup();
         exit(1);
     }
+    // 先把所有图片交给后台线程并行解码，下面的 get() 只需等待解码完成并上传
+    TextureCache::getInstance().preload(renderer, PATH_BG);
+    TextureCache::getInstance().preload(renderer, PATH_NUM);
+    for (int i = 0; i < 4; i++) {
+        TextureCache::getInstance().preload(renderer, PATH_PLAYERS[i][0]);
+        TextureCache::getInstance().preload(renderer, PATH_PLAYERS[i][1]);
+    }
     texBG = TextureCache::getInstance().get(renderer, PATH_BG);
     SDL_QueryTexture(texBG.get(), nullptr, nullptr, &bgW, &bgH);
     shared_ptr<SDL_Texture> texTxt;
@@ -147,7 +163,7 @@ void loadResources(SDL_Renderer* renderer) {
         countDown = 4;
     });
     texNumbers = TextureCache::getInstance().get(renderer, PATH_NUM);
-    atlasNumbers = AtlasIndexCache::getInstance().get(texNumbers.get(), PATH_NUM, 19, 22, 0, 0, 1, 10);
+    atlasNumbers = AtlasIndexCache::getInstance().get(texNumbers.get(), PATH_NUM, ClipGrid<19, 22, 0, 0, 1, 10>::DESC);
     rectNumber = new SDL_Rect({SCREEN_WIDTH / 2 - 19, SCREEN_HEIGHT / 2 - 22, 19*2, 22*2});
     for (int i = 0; i < 4; i++) {
         players[i].init(renderer, PATH_PLAYERS[i][0], PATH_PLAYERS[i][1]);
@@ -196,6 +212,7 @@ bool init() {
         SDL_Quit();
         return false;
     }
+    AssetBundle::getInstance().open(PATH_BUNDLE);
     loadResources(renderer);
     return true;
 }
@@ -226,6 +243,7 @@ void connectToServer(const HostAnnounce& server) {
 }
 
 void connectServer() {
+    PROFILE_ZONE("net.connect");
     if (!client.connectAndLogin(strAddrServ, portServ, me.id)) {
         showMessageBox("Login Error", "Login failed");
         exit(1);
@@ -248,11 +266,21 @@ void connectServer() {
 #endif
 
 int main(int argc, char* argv[]) {
-    (void)argc; (void)argv;  // Avoid unused parameter warnings
     using namespace std::chrono;
+    string tracePath; // --trace out.json：记录分析区间，退出时按 Chrome trace 格式写出
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--trace" && i + 1 < argc) tracePath = argv[++i];
+    }
+    Profiler::setThreadName("main");
+    if (!tracePath.empty()) {
+        Profiler::getInstance().startTrace();
+    }
+    const Uint64 launchCounter = SDL_GetPerformanceCounter();
     if (!init()) {
         return 1;
     }
+    SDL_Log("启动耗时: %.1f ms（%s）", (SDL_GetPerformanceCounter() - launchCounter) * 1000.0 / SDL_GetPerformanceFrequency(),
+            AssetBundle::getInstance().isOpen() ? "资源包" : "散文件");
     Timer countDownTimer;
     Camera cameraUI, cameraScene;
     cameraUI.setMaxSize(SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -286,11 +314,13 @@ int main(int argc, char* argv[]) {
     while (running) {
         steady_clock::time_point frameStart = steady_clock::now();
         duration<float> delta = duration<float>(frameStart - lastTick);
-        // 处理输入
+        // 处理输入（含等待事件的时间）
+        ProfileZone inputZone("input");
         if (SDL_WaitEventTimeout(&evt, 5)) {
             do {
                 if (evt.type == SDL_QUIT) running = false;
                 if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_ESCAPE) running = false;
+                if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_F3) Profiler::getInstance().toggleOverlay();
                 if (evt.type == SDL_TEXTINPUT) {
                     const string &strLine = strLineList[idxLine];
                     int len = strlen(evt.text.text);
@@ -351,7 +381,9 @@ int main(int argc, char* argv[]) {
                 }
             } while (SDL_PollEvent(&evt));
         }
+        inputZone.end();
         // 处理游戏更新
+        ProfileZone updateZone("update");
         progresses = client.getLatestProgress();
         switch (stage) {
         case Stage::MENU:
@@ -380,14 +412,18 @@ int main(int argc, char* argv[]) {
         default:
             break;
         }
+        updateZone.end();
         // 处理渲染
+        ProfileZone renderZone("render");
         SDL_RenderClear(renderer);
         srcBG.x = cameraScene.getPosition().x;
         srcBG.y = cameraScene.getPosition().y;
         SDL_RenderCopy(renderer, texBG.get(), &srcBG, &dstBG);
+        spriteBatch.begin(renderer);
         for (int i = 0; i < progresses.size(); ++i) {
-            players[i].onRender(renderer, cameraScene);
+            players[i].onRender(spriteBatch, cameraScene);
         }
+        spriteBatch.flush();
         switch (stage) {
         case Stage::MENU:
             btnServer.render(renderer);
@@ -426,7 +462,7 @@ int main(int argc, char* argv[]) {
             break;
         case Stage::READY:
             if (0 <= countDown && countDown <= 3) {
-                SDL_RenderCopy(renderer, texNumbers.get(), &atlasNumbers->frames[0][countDown], rectNumber);
+                SDL_RenderCopy(renderer, texNumbers.get(), &atlasNumbers->frame(0, countDown), rectNumber);
             }
             break;
         case Stage::RACING:
@@ -444,7 +480,12 @@ int main(int argc, char* argv[]) {
             }
             break;
         }
+        renderZone.end();
+        Profiler::getInstance().renderOverlay(renderer);
+        ProfileZone presentZone("present");
         SDL_RenderPresent(renderer);
+        presentZone.end();
+        Profiler::getInstance().endFrame();
 
         lastTick = frameStart;
         nanoseconds sleepDuration = frameDuration - (steady_clock::now() - frameStart);
@@ -456,6 +497,7 @@ int main(int argc, char* argv[]) {
     client.stop();
     broadcaster.stop();
     listener.stop();
+    if (!tracePath.empty()) Profiler::getInstance().writeTrace(tracePath);
     cleanup();
     return 0;
 }
\ No newline at end of file
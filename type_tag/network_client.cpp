@@ -1,16 +1,22 @@
 #include "network_client.h"
 #include "dto.h"
+#include "profiler.h"
 
 NetworkClient::~NetworkClient() {
     stop();
 }
 
-bool NetworkClient::connectAndLogin(const string& addr, int port, int& outId) {
+bool NetworkClient::connectAndLogin(const string& addr, int port, int& outId, int room) {
     host_ = addr;
     port_ = port;
+    room_ = room;
     client_ = make_unique<httplib::Client>(addr, port);
     client_->set_keep_alive(true);
+    client_->set_default_headers({{ROOM_HEADER, to_string(room)}});
+    client_->set_tcp_nodelay(true); // 请求头和正文分两次写，开着 Nagle 时正文要等服务器的延迟确认
+    const auto t0 = chrono::steady_clock::now();
     httplib::Result res = client_->Post("/login");
+    recordRequest(RequestKind::Login, t0, res && res->status == 200);
     if (!res) {
         cout << "login failed: no response" << endl;
         return false; 
@@ -35,16 +41,42 @@ bool NetworkClient::connectAndLogin(const string& addr, int port, int& outId) {
         me_.id = id;
         me_.progress = 0;
     }
+    channelPort_ = 0;
+    if (res->has_header(PROGRESS_PORT_HEADER)) {
+        channelPort_ = atoi(res->get_header_value(PROGRESS_PORT_HEADER).c_str());
+    }
     outId = id;
     return true;
 }
 
+bool NetworkClient::createRoom(const string& addr, int port, const string& text, int maxPlayers, int& outRoom) {
+    httplib::Client cli(addr, port);
+    auto res = cli.Post("/rooms?players=" + to_string(maxPlayers), text, "text/plain; charset=utf-8");
+    if (!res) {
+        cout << "createRoom failed: no response" << endl;
+        return false;
+    }
+    if (res->status != 200) {
+        cout << "createRoom failed: status " << res->status << endl;
+        return false;
+    }
+    try {
+        outRoom = stoi(res->body);
+    } catch (...) {
+        cout << "createRoom failed: invalid id" << endl;
+        return false;
+    }
+    return true;
+}
+
 bool NetworkClient::fetchText(string& outText) {
     if (!client_) {
         cout << "fetchText failed: not connected" << endl;
         return false;
     }
+    const auto t0 = chrono::steady_clock::now();
     auto res = client_->Post("/text");
+    recordRequest(RequestKind::Text, t0, res && res->status == 200);
     if (!res) {
         cout << "fetchText failed: no response" << endl;
         return false;
@@ -70,7 +102,18 @@ vector<int> NetworkClient::getLatestProgress() const {
 void NetworkClient::startProgressLoop(chrono::milliseconds interval) {
     if (running_) return;
     running_ = true;
+    if (eventsEnabled_) {
+        // 在这里创建而不是在工作线程上，stop 可以随时调用它的 stop 打断阻塞的读取
+        eventsClient_ = make_unique<httplib::Client>(host_, port_);
+        eventsClient_->set_read_timeout(chrono::milliseconds(EVENTS_PING_MS * 3));
+        eventsClient_->set_tcp_nodelay(true);
+        eventsClient_->set_default_headers({{ROOM_HEADER, to_string(room_)}});
+    }
     worker_ = thread([this, interval]() {
+        Profiler::setThreadName("net-client");
+        if (channelEnabled_ && channelPort_ > 0 && runChannel()) return;
+        if (eventsClient_ && runEvents()) return;
+        // 服务器不支持推送或连接断开：退回 HTTP 轮询
         while (running_) {
             postProgressOnce();
             this_thread::sleep_for(interval);
@@ -78,17 +121,20 @@ void NetworkClient::startProgressLoop(chrono::milliseconds interval) {
     });
 }
 
-bool NetworkClient::postProgressOnce() {
+bool NetworkClient::postProgressOnce(bool applySnapshot) {
+    PROFILE_ZONE("net.progress");
     if (!client_) {
         cout << "postProgressOnce failed: not connected" << endl;
         return false;
     }
-    PlayerDto snapshot;
+    uint8_t body[PLAYER_DTO_SIZE];
     {
         lock_guard<mutex> lk(mtx_);
-        snapshot = me_;
+        me_.encode(body, sizeof(body));
     }
-    auto res = client_->Post("/progress", snapshot.serialize(), "text/plain");
+    const auto t0 = chrono::steady_clock::now();
+    auto res = client_->Post("/progress", (const char *)body, sizeof(body), DTO_CONTENT_TYPE);
+    recordRequest(RequestKind::Progress, t0, res && res->status == 200);
     if (!res) {
         cout << "postProgressOnce failed: no response" << endl;
         return false;
@@ -97,17 +143,154 @@ bool NetworkClient::postProgressOnce() {
         cout << "postProgressOnce failed: status " << res->status << endl;
         return false;
     }
-    auto newProgresses = deserializeProgresses(res->body);
+    if (!applySnapshot) return true;
+    // 解码失败时 progresses_ 保持不变；玩家数不变时复用原有内存
+    lock_guard<mutex> lk(mtx_);
+    if (!decodeProgresses(res->body, progresses_)) {
+        cout << "postProgressOnce failed: bad response" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool NetworkClient::runChannel() {
+    const socket_t sock = connectChannel(host_, channelPort_);
+    if (sock == INVALID_SOCKET) {
+        cout << "progress channel: connect failed, falling back to HTTP" << endl;
+        return false;
+    }
+    int id;
     {
         lock_guard<mutex> lk(mtx_);
-        progresses_ = move(newProgresses);
+        id = me_.id;
     }
-    return true;
+    uint8_t frame[PROGRESS_FRAME_SIZE * 2];
+    encodeFrame({FrameType::Hello, id, PROGRESS_CHANNEL_VERSION}, frame);
+    encodeFrame({FrameType::Room, 0, room_}, frame + PROGRESS_FRAME_SIZE);
+    bool ok = sendFrames(sock, frame, sizeof(frame));
+    channelActive_ = ok;
+    // 之后不再走 HTTP：关掉保持着的连接，服务器上等待这条连接的线程随即释放（再发请求时会自动重连）
+    if (ok) client_->stop();
+    int sent = -1;
+    bool echoPending = false; // 统计用：刚发出的进度还没被服务器推回来
+    chrono::steady_clock::time_point sentAt;
+    FrameReader reader;
+    pollfd pfd{sock, POLLIN, 0};
+    while (ok && running_) {
+        // 只在进度变化时上报，同一 tick 内的多次输入合并为一帧
+        int progress;
+        {
+            lock_guard<mutex> lk(mtx_);
+            progress = me_.progress;
+        }
+        if (progress != sent) {
+            encodeFrame({FrameType::Progress, id, progress}, frame);
+            ok = sendFrames(sock, frame, PROGRESS_FRAME_SIZE);
+            sent = progress;
+            if (stats_) {
+                stats_->sent(RequestKind::Progress);
+                sentAt = chrono::steady_clock::now();
+                echoPending = true;
+            }
+            if (!ok) break;
+        }
+        pfd.revents = 0;
+        const int ready = httplib::detail::poll_wrapper(&pfd, 1, PROGRESS_CHANNEL_TICK_MS);
+        if (ready < 0) {
+            ok = false;
+            break;
+        }
+        if (ready == 0) continue;
+        PROFILE_ZONE("net.channel");
+        const ssize_t n = httplib::detail::read_socket(sock, reader.space(), reader.spaceSize(), 0);
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        reader.commit((int)n);
+        ProgressFrame f;
+        lock_guard<mutex> lk(mtx_);
+        while (reader.next(f)) {
+            if (f.type == FrameType::Players) {
+                progresses_.resize(min(max(f.value, 0), 1 << 16)); // id 只有 16 位
+            } else if (f.type == FrameType::Progress && f.id < (int)progresses_.size()) {
+                progresses_[f.id] = f.value;
+                if (echoPending && f.id == id && f.value == sent) {
+                    stats_->completed(RequestKind::Progress, sentAt, true);
+                    echoPending = false;
+                }
+            }
+        }
+        ok = !reader.bad();
+    }
+    closeChannel(sock);
+    channelActive_ = false;
+    if (!ok && echoPending) stats_->completed(RequestKind::Progress, sentAt, false);
+    if (!ok) cout << "progress channel: disconnected, falling back to HTTP" << endl;
+    return ok;
+}
+
+bool NetworkClient::runEvents() {
+    // 上报线程：只在进度变化时 POST，响应里的快照不用，以推送的为准（两者先后不定，混用可能让进度回退）
+    atomic<bool> streaming{true};
+    thread sender([this, &streaming]() {
+        Profiler::setThreadName("net-send");
+        int sent = -1;
+        while (running_ && streaming) {
+            int progress;
+            {
+                lock_guard<mutex> lk(mtx_);
+                progress = me_.progress;
+            }
+            if (progress != sent && postProgressOnce(false)) sent = progress;
+            this_thread::sleep_for(chrono::milliseconds(EVENTS_TICK_MS));
+        }
+    });
+    string buffer;
+    auto res = eventsClient_->Get("/events",
+        [this](const httplib::Response& r) {
+            eventsActive_ = r.status == 200 && running_;
+            return eventsActive_.load();
+        },
+        [this, &buffer](const char* data, size_t len) {
+            PROFILE_ZONE("net.events");
+            buffer.append(data, len);
+            // 事件以空行结束；只关心 data 行，以 ':' 开头的保活注释直接丢弃
+            size_t end;
+            while ((end = buffer.find("\n\n")) != string::npos) {
+                if (buffer.compare(0, 6, "data: ") == 0) {
+                    // 直接解析进 progresses_，复用它的容量；格式不对的快照丢弃
+                    lock_guard<mutex> lk(mtx_);
+                    parseProgresses(string_view(buffer).substr(6, end - 6), progresses_);
+                }
+                buffer.erase(0, end + 2);
+            }
+            return running_.load();
+        });
+    const bool subscribed = eventsActive_;
+    eventsActive_ = false;
+    streaming = false;
+    sender.join();
+    if (!running_) return true;
+    if (subscribed) {
+        cout << "progress events: disconnected, falling back to polling" << endl;
+    } else {
+        cout << "progress events: subscribe failed, falling back to polling" << endl;
+    }
+    return false;
+}
+
+void NetworkClient::recordRequest(RequestKind kind, chrono::steady_clock::time_point start, bool ok) {
+    if (!stats_) return;
+    stats_->sent(kind);
+    stats_->completed(kind, start, ok);
 }
 
 void NetworkClient::stop() {
     if (!running_) return;
     running_ = false;
+    if (eventsClient_) eventsClient_->stop();
     if (worker_.joinable()) worker_.join();
+    eventsClient_.reset();
     client_.reset();
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "./libs/httplib.h"
 #include "dto.h"
+#include "progress_channel.h"
+#include "request_stats.h"
 #include <string>
 #include <vector>
 
@@ -11,27 +13,79 @@ public:
     NetworkClient() = default;
     ~NetworkClient();
 
-    bool connectAndLogin(const string& addr, int port, int& outId);
+    /**
+     * 登录到指定房间，之后的请求都带上该房间的 X-Room 头
+     */
+    bool connectAndLogin(const string& addr, int port, int& outId, int room = DEFAULT_ROOM);
+    /**
+     * 在服务器上新建一个房间，text 为空时使用服务器的默认文本
+     */
+    static bool createRoom(const string& addr, int port, const string& text, int maxPlayers, int& outRoom);
 
     bool fetchText(string& outText);
 
+    /**
+     * 启动后台同步进度，依次尝试：
+     * 1. 进度通道：只在进度变化时上报，由服务器推送他人进度
+     * 2. 订阅 HTTP /events 推送他人进度，另起线程在自己进度变化时 POST /progress
+     * 3. 按 interval 轮询 HTTP /progress
+     * 前一种不可用或断开后退到下一种
+     */
     void startProgressLoop(chrono::milliseconds interval = chrono::milliseconds(100));
 
     void submitProgress(int progress);
 
     vector<int> getLatestProgress() const;
 
+    bool usingChannel() const { return channelActive_; }
+    bool usingEvents() const { return eventsActive_; }
+    /**
+     * 关闭后即使服务器提供进度通道也不用，用于对比测试；需在 startProgressLoop 之前调用
+     */
+    void setChannelEnabled(bool enabled) { channelEnabled_ = enabled; }
+    /**
+     * 关闭后不订阅 /events，用于对比测试；需在 startProgressLoop 之前调用
+     */
+    void setEventsEnabled(bool enabled) { eventsEnabled_ = enabled; }
+    /**
+     * 把请求数、错误数和往返延迟记到 stats（可多个客户端共用），用于压力测试；需在 connectAndLogin 或 startProgressLoop 之前调用
+     */
+    void setStats(RequestStats* stats) { stats_ = stats; }
+
     void stop();
 private:
-    bool postProgressOnce();
+    /**
+     * 上报自己的进度；applySnapshot 为 true 时用响应里的快照更新他人进度
+     */
+    bool postProgressOnce(bool applySnapshot = true);
+    /**
+     * 在进度通道上收发直到 stop；连接失败或断开时返回 false
+     */
+    bool runChannel();
+    /**
+     * 在工作线程上读取 /events 直到 stop，期间由另一个线程上报自己的进度；订阅失败或断开时返回 false
+     */
+    bool runEvents();
+    /**
+     * 同步 HTTP 请求完成后调用，没有设置 stats_ 时什么也不做
+     */
+    void recordRequest(RequestKind kind, chrono::steady_clock::time_point start, bool ok);
 
     unique_ptr<httplib::Client> client_;
     string host_;
     int port_;
+    int room_ = DEFAULT_ROOM;
+    int channelPort_ = 0; // 登录响应里的进度通道端口，0 表示服务器没有通道
+    bool channelEnabled_ = true;
+    bool eventsEnabled_ = true;
+    unique_ptr<httplib::Client> eventsClient_; // /events 长连接单独占一个客户端
+    RequestStats* stats_ = nullptr;
 
     mutable mutex mtx_;
     PlayerDto me_;
     vector<int> progresses_;
     atomic<bool> running_{false};
+    atomic<bool> channelActive_{false};
+    atomic<bool> eventsActive_{false};
     thread worker_;
 };
\ No newline at end of file
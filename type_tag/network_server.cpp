@@ -1,4 +1,33 @@
 #include "network_server.h"
+#include "profiler.h"
+#include <cstring>
+
+using namespace chrono;
+
+static const int CHANNEL_MAX_PEERS = 8192; // 进度通道同时保持的连接上限（所有房间合计）
+
+// 请求在 httplib 线程池的线程上处理，这些线程不是我们创建的，第一次处理请求时再命名
+static void nameServerThread() {
+    static thread_local bool named = false;
+    if (named) return;
+    Profiler::setThreadName("net-server");
+    named = true;
+}
+
+// 按 X-Room 头找到请求的房间并记为活动；房间不存在时设置 404 并返回空
+static shared_ptr<GameState> routeRoom(const RoomDirectory& rooms, const httplib::Request& req, httplib::Response& res) {
+    int id = DEFAULT_ROOM;
+    if (req.has_header(ROOM_HEADER)) {
+        id = atoi(req.get_header_value(ROOM_HEADER).c_str());
+    }
+    shared_ptr<GameState> room = rooms.find(id);
+    if (!room) {
+        res.status = 404;
+        return nullptr;
+    }
+    room->markActive();
+    return room;
+}
 
 NetworkServer::~NetworkServer() {
     stop();
@@ -6,41 +35,149 @@ NetworkServer::~NetworkServer() {
 
 void NetworkServer::setupRoutes() {
     server_->set_logger([](const httplib::Request&, const httplib::Response&) {});
-    server_->Post("/text", [st = state_](const httplib::Request&, httplib::Response& res) {
+    // /events 每个 tick 只写一小段，开着 Nagle 时要等客户端延迟确认才发得出去
+    server_->set_tcp_nodelay(true);
+    server_->Post("/rooms", [rooms = rooms_, text = defaultText_](const httplib::Request& req, httplib::Response& res) {
+        nameServerThread();
+        PROFILE_ZONE("srv.rooms");
+        int players = 2;
+        if (req.has_param("players")) {
+            players = atoi(req.get_param_value("players").c_str());
+        }
+        if (players < 1 || players > ROOM_MAX_PLAYERS) {
+            res.status = 400;
+            return;
+        }
+        shared_ptr<GameState> room = rooms->create(req.body.empty() ? text : req.body, players);
+        if (!room) {
+            res.status = 503;
+            return;
+        }
+        res.set_content(to_string(room->id), "text/plain");
+    });
+    server_->Post("/text", [rooms = rooms_](const httplib::Request& req, httplib::Response& res) {
+        nameServerThread();
+        PROFILE_ZONE("srv.text");
+        shared_ptr<GameState> st = routeRoom(*rooms, req, res);
+        if (!st) return;
         lock_guard<mutex> lk(st->mtx_);
         res.set_content(st->text, "text/plain; charset=utf-8");
     });
-    server_->Post("/login", [st = state_](const httplib::Request&, httplib::Response& res) {
+    server_->Post("/login", [rooms = rooms_](const httplib::Request& req, httplib::Response& res) {
+        nameServerThread();
+        PROFILE_ZONE("srv.login");
+        shared_ptr<GameState> st = routeRoom(*rooms, req, res);
+        if (!st) return;
         lock_guard<mutex> lk(st->mtx_);
         int id = (int)st->progresses_.size();
-        if (id >= st->maxPlayers) {
+        if (st->closing || id >= st->maxPlayers) {
             res.set_content("-1", "text/plain");
             return;
         }
         st->progresses_.push_back(0);
+        st->touch();
+        if (rooms->channelPort() > 0) {
+            res.set_header(PROGRESS_PORT_HEADER, to_string(rooms->channelPort()));
+        }
         res.set_content(to_string(id), "text/plain");
     });
-    server_->Post("/progress", [st = state_](const httplib::Request& req, httplib::Response& res) {
-        PlayerDto p = PlayerDto::deserialize(req.body);
+    server_->Post("/progress", [rooms = rooms_](const httplib::Request& req, httplib::Response& res) {
+        nameServerThread();
+        PROFILE_ZONE("srv.progress");
+        PlayerDto p;
+        if (!PlayerDto::decode(req.body, p)) {
+            res.status = 400;
+            return;
+        }
+        shared_ptr<GameState> st = routeRoom(*rooms, req, res);
+        if (!st) return;
+        string body;
         {
             lock_guard<mutex> lk(st->mtx_);
-            if (p.id >= 0 && p.id < (int)st->progresses_.size()) {
+            if (p.id >= 0 && p.id < (int)st->progresses_.size() && st->progresses_[p.id] != p.progress) {
                 st->progresses_[p.id] = p.progress;
+                st->touch();
             }
-            res.set_content(serializeProgresses(st->progresses_), "text/plain");
+            // 直接编码进响应正文，不经过中间字符串
+            body.resize(encodedProgressesSize(st->progresses_.size()));
+            encodeProgresses(st->progresses_.data(), st->progresses_.size(), (uint8_t *)&body[0], body.size());
         }
+        res.set_content(move(body), DTO_CONTENT_TYPE);
+    });
+    setupEvents();
+}
+
+void NetworkServer::setupEvents() {
+    server_->Get("/events", [rooms = rooms_](const httplib::Request& req, httplib::Response& res) {
+        nameServerThread();
+        shared_ptr<GameState> st = routeRoom(*rooms, req, res);
+        if (!st) return;
+        res.set_header("Cache-Control", "no-cache");
+        // 每次调用推送一条事件或保活注释；sent 为 0 保证连上后先收到一次完整快照
+        res.set_chunked_content_provider("text/event-stream",
+            [st, sent = (uint64_t)0, last = steady_clock::time_point()](size_t, httplib::DataSink& sink) mutable {
+                // 距上次推送不足一个 tick 时先等满，这段时间里的变化合并进同一个快照
+                this_thread::sleep_until(last + milliseconds(EVENTS_TICK_MS));
+                // 有人订阅的房间不算空闲
+                st->markActive();
+                shared_ptr<const string> event;
+                vector<int> progresses;
+                uint64_t version;
+                {
+                    unique_lock<mutex> lk(st->mtx_);
+                    st->changed_.wait_for(lk, milliseconds(EVENTS_PING_MS),
+                                          [&] { return st->closing || st->version != sent; });
+                    if (st->closing) {
+                        lk.unlock();
+                        sink.done();
+                        return true;
+                    }
+                    version = st->version;
+                    if (version == sent) {
+                        lk.unlock();
+                        static const char PING[] = ":\n\n";
+                        return sink.write(PING, sizeof(PING) - 1);
+                    }
+                    // 同一版本只格式化一次：已有缓存直接共用，否则只在锁内拷贝进度，格式化放到锁外
+                    if (st->eventVersion == version) {
+                        event = st->eventSnapshot;
+                    } else {
+                        progresses = st->progresses_;
+                    }
+                }
+                if (!event) {
+                    PROFILE_ZONE("srv.events");
+                    // 按上限一次分配好，直接格式化进事件字符串
+                    static const char PREFIX[] = "data: ";
+                    const size_t prefix = sizeof(PREFIX) - 1;
+                    auto text = make_shared<string>(prefix + maxProgressesTextSize(progresses.size()) + 2, '\0');
+                    memcpy(&(*text)[0], PREFIX, prefix);
+                    size_t len = prefix + formatProgresses(progresses.data(), progresses.size(), &(*text)[prefix], text->size() - prefix);
+                    (*text)[len++] = '\n';
+                    (*text)[len++] = '\n';
+                    text->resize(len);
+                    event = move(text);
+                    lock_guard<mutex> lk(st->mtx_);
+                    if (st->eventVersion < version) {
+                        st->eventSnapshot = event;
+                        st->eventVersion = version;
+                    }
+                }
+                sent = version;
+                last = steady_clock::now();
+                // 写失败说明客户端已断开，返回 false 结束这条连接、释放线程
+                return sink.write(event->data(), event->size());
+            });
     });
 }
 
 bool NetworkServer::start(const string& bindAddr, int port, const string& text, int maxPlayers) {
     if (running_) return true;
     port_ = port;
-    {
-        lock_guard<mutex> lk(state_->mtx_);
-        state_->text = text;
-        state_->maxPlayers = maxPlayers;
-        state_->progresses_.clear();
-    }
+    defaultText_ = text;
+    // 每次启动用新的目录，房间 id 从默认房间 0 重新编号
+    rooms_ = make_shared<RoomDirectory>();
+    rooms_->create(text, maxPlayers, true);
     server_ = make_unique<httplib::Server>();
     setupRoutes();
     if (!server_->bind_to_port(bindAddr, port)) {
@@ -53,13 +190,221 @@ bool NetworkServer::start(const string& bindAddr, int port, const string& text,
         server_->listen_after_bind();
         running_ = false;
     });
+    {
+        lock_guard<mutex> lk(reaperMutex_);
+        reaperStop_ = false;
+    }
+    reaper_ = thread([this]() { reapLoop(); });
+    // 进度通道开不起来时只用 HTTP，客户端收不到端口头会继续轮询
+    const int channelPort = port + PROGRESS_CHANNEL_PORT_OFFSET;
+    channelListener_ = openChannelListener(bindAddr, channelPort);
+    if (channelListener_ == INVALID_SOCKET) {
+        cout << "Failed to open progress channel on port " << channelPort << endl;
+    } else {
+        rooms_->setChannelPort(channelPort);
+        channelRunning_ = true;
+        channelWorker_ = thread([this]() { channelLoop(); });
+    }
     return true;
 }
 
+void NetworkServer::reapLoop() {
+    Profiler::setThreadName("net-reaper");
+    unique_lock<mutex> lk(reaperMutex_);
+    while (!reaperCv_.wait_for(lk, milliseconds(ROOM_REAP_INTERVAL_MS), [this] { return reaperStop_; })) {
+        lk.unlock();
+        int reaped;
+        {
+            PROFILE_ZONE("srv.reap");
+            reaped = rooms_->reap(ROOM_IDLE_MS);
+        }
+        if (reaped > 0) {
+            cout << "reaped " << reaped << " idle rooms, " << rooms_->size() << " left" << endl;
+        }
+        lk.lock();
+    }
+}
+
+namespace {
+struct ChannelPeer {
+    socket_t sock;
+    int id = -1;               // HELLO 之前为 -1
+    int room = -1;             // ROOM 之前为 -1，不推送
+    bool needsSnapshot = true; // 下次推送时先发完整快照
+    bool dead = false;
+    FrameReader reader;
+};
+
+// 至少有一个通道连接的房间
+struct ChannelRoom {
+    shared_ptr<GameState> state;
+    vector<int> pushed;          // 上次推送出去的进度
+    vector<ChannelPeer *> peers; // 本 tick 在这个房间里的连接
+};
+
+void appendFrame(vector<uint8_t> &out, FrameType type, int id, int value) {
+    out.resize(out.size() + PROGRESS_FRAME_SIZE);
+    encodeFrame({type, id, value}, &out[out.size() - PROGRESS_FRAME_SIZE]);
+}
+}
+
+void NetworkServer::channelLoop() {
+    Profiler::setThreadName("net-channel");
+    const shared_ptr<RoomDirectory> directory = rooms_;
+    vector<unique_ptr<ChannelPeer>> peers;
+    unordered_map<int, ChannelRoom> rooms;
+    vector<pollfd> fds;
+    vector<int> current;             // 本 tick 某个房间的进度
+    vector<uint8_t> delta, snapshot; // 变化的部分、给新连接的完整快照
+    auto nextPush = steady_clock::now();
+    while (channelRunning_) {
+        fds.resize(peers.size() + 1);
+        fds[0] = {channelListener_, POLLIN, 0};
+        for (size_t i = 0; i < peers.size(); ++i) {
+            fds[i + 1] = {peers[i]->sock, POLLIN, 0};
+        }
+        const int timeout = max(0, (int)duration_cast<milliseconds>(nextPush - steady_clock::now()).count());
+        const int ready = httplib::detail::poll_wrapper(fds.data(), (nfds_t)fds.size(), timeout);
+        ProfileZone zone("srv.channel");
+        // 只在 poll 之前已有的连接上读，新接受的连接下一轮再读
+        const size_t polled = fds.size() - 1;
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            for (;;) {
+                const socket_t sock = accept(channelListener_, nullptr, nullptr);
+                if (sock == INVALID_SOCKET) break;
+                if ((int)peers.size() >= CHANNEL_MAX_PEERS) {
+                    closeChannel(sock);
+                    continue;
+                }
+                httplib::detail::set_nonblocking(sock, true);
+                httplib::detail::set_socket_opt(sock, IPPROTO_TCP, TCP_NODELAY, 1);
+                peers.push_back(make_unique<ChannelPeer>());
+                peers.back()->sock = sock;
+            }
+        }
+        for (size_t i = 0; ready > 0 && i < polled; ++i) {
+            if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ChannelPeer &peer = *peers[i];
+            const ssize_t n = httplib::detail::read_socket(peer.sock, peer.reader.space(), peer.reader.spaceSize(), 0);
+            if (n <= 0) {
+                peer.dead = true;
+                continue;
+            }
+            peer.reader.commit((int)n);
+            ProgressFrame f;
+            bool updated = false;
+            int progress = 0;
+            while (!peer.dead && peer.reader.next(f)) {
+                if (f.type == FrameType::Hello) {
+                    peer.id = f.id;
+                    peer.dead = f.value != PROGRESS_CHANNEL_VERSION;
+                } else if (f.type == FrameType::Room && peer.id >= 0 && peer.room < 0) {
+                    // 第一次有人进这个房间时才查目录，之后本线程直接用 rooms 里的指针
+                    if (!rooms.count(f.value)) {
+                        shared_ptr<GameState> st = directory->find(f.value);
+                        if (st) rooms[f.value].state = move(st);
+                    }
+                    peer.room = rooms.count(f.value) ? f.value : -1;
+                    peer.dead = peer.room < 0;
+                } else if (f.type == FrameType::Progress && peer.room >= 0 && f.id == peer.id) {
+                    // 同一次读到的多帧只保留最后一个进度
+                    updated = true;
+                    progress = f.value;
+                }
+            }
+            if (peer.reader.bad()) peer.dead = true;
+            if (updated && !peer.dead) {
+                GameState &st = *rooms[peer.room].state;
+                lock_guard<mutex> lk(st.mtx_);
+                if (peer.id < (int)st.progresses_.size() && st.progresses_[peer.id] != progress) {
+                    st.progresses_[peer.id] = progress;
+                    st.touch();
+                }
+            }
+        }
+        // 每个 tick 最多推送一次：同一 tick 内的多次变化合并，只发变化的玩家；HTTP 接口改动的进度也在这里推出去
+        if (steady_clock::now() >= nextPush) {
+            nextPush = steady_clock::now() + milliseconds(PROGRESS_CHANNEL_TICK_MS);
+            for (auto &kv : rooms) kv.second.peers.clear();
+            for (auto &peer : peers) {
+                if (!peer->dead && peer->room >= 0) rooms[peer->room].peers.push_back(peer.get());
+            }
+            for (auto it = rooms.begin(); it != rooms.end();) {
+                ChannelRoom &room = it->second;
+                bool closing = room.peers.empty();
+                if (!closing) {
+                    lock_guard<mutex> lk(room.state->mtx_);
+                    closing = room.state->closing;
+                    current = room.state->progresses_;
+                }
+                if (closing) {
+                    // 房间已被回收：断开其中的连接，客户端会退回 HTTP，再请求时得到 404
+                    for (ChannelPeer *peer : room.peers) peer->dead = true;
+                    it = rooms.erase(it);
+                    continue;
+                }
+                room.state->markActive();
+                delta.clear();
+                if (current.size() != room.pushed.size()) {
+                    appendFrame(delta, FrameType::Players, 0, (int)current.size());
+                }
+                for (size_t i = 0; i < current.size(); ++i) {
+                    if (i >= room.pushed.size() || current[i] != room.pushed[i]) {
+                        appendFrame(delta, FrameType::Progress, (int)i, current[i]);
+                    }
+                }
+                snapshot.clear();
+                for (ChannelPeer *peer : room.peers) {
+                    if (peer->needsSnapshot) {
+                        if (snapshot.empty()) {
+                            appendFrame(snapshot, FrameType::Players, 0, (int)current.size());
+                            for (size_t i = 0; i < current.size(); ++i) {
+                                appendFrame(snapshot, FrameType::Progress, (int)i, current[i]);
+                            }
+                        }
+                        peer->needsSnapshot = false;
+                        peer->dead = !sendFrames(peer->sock, snapshot.data(), snapshot.size());
+                    } else if (!delta.empty()) {
+                        // 发送缓冲满说明客户端跟不上，直接断开，客户端会退回 HTTP 轮询
+                        peer->dead = !sendFrames(peer->sock, delta.data(), delta.size());
+                    }
+                }
+                room.pushed.swap(current);
+                ++it;
+            }
+        }
+        for (size_t i = 0; i < peers.size();) {
+            if (!peers[i]->dead) {
+                ++i;
+                continue;
+            }
+            closeChannel(peers[i]->sock);
+            peers[i] = move(peers.back());
+            peers.pop_back();
+        }
+    }
+    for (auto &peer : peers) {
+        closeChannel(peer->sock);
+    }
+}
+
 void NetworkServer::stop() {
     if (!server_) return;
+    // 先关闭所有房间，叫醒等待进度变化的 /events 连接，否则 server_->stop 要等它们的线程返回
+    rooms_->closeAll();
     server_->stop();
     if (worker_.joinable()) worker_.join();
     server_.reset();
     running_ = false;
-}
\ No newline at end of file
+    {
+        lock_guard<mutex> lk(reaperMutex_);
+        reaperStop_ = true;
+    }
+    reaperCv_.notify_all();
+    if (reaper_.joinable()) reaper_.join();
+    channelRunning_ = false;
+    if (channelWorker_.joinable()) channelWorker_.join();
+    closeChannel(channelListener_);
+    channelListener_ = INVALID_SOCKET;
+    rooms_->setChannelPort(0);
+}
@@ -1,18 +1,20 @@
 #pragma once
 #include "./libs/httplib.h"
 #include "dto.h"
+#include "progress_channel.h"
+#include "room_directory.h"
+#include <condition_variable>
 #include <string>
 #include <vector>
 
 using namespace std;
 
-struct GameState {
-    mutex mtx_;
-    string text;
-    int maxPlayers = 2;
-    vector<int> progresses_;
-};
-
+/**
+ * 比赛服务器：一个进程同时承载多个房间
+ *   POST /rooms?players=N  正文为比赛文本（为空时用 start 的文本），返回房间 id
+ *   POST /login /text /progress、GET /events  用 X-Room 头指定房间，没有时进入默认房间；房间不存在返回 404
+ * start 时建立默认房间（不会被回收），其余房间空闲 ROOM_IDLE_MS 后由回收线程关闭
+ */
 class NetworkServer {
 public:
     NetworkServer() = default;
@@ -22,12 +24,36 @@ public:
     void stop();
     bool isRunning() const { return running_; }
     int port() const { return port_; }
+    int roomCount() const { return rooms_->size(); }
 private:
     void setupRoutes();
+    /**
+     * GET /events：Server-Sent Events 流，房间的 progresses_ 变化时推送一条 data 为文本格式快照（formatProgresses）的事件，
+     * 每 EVENTS_TICK_MS 最多一条；每个订阅者占用 httplib 线程池中的一个线程直到断开
+     */
+    void setupEvents();
+    /**
+     * 进度通道线程：接收各客户端的进度帧，每个 tick 把各房间有变化的进度推给该房间的客户端
+     */
+    void channelLoop();
+    /**
+     * 回收线程：每 ROOM_REAP_INTERVAL_MS 回收一次空闲房间
+     */
+    void reapLoop();
 private:
-    shared_ptr<GameState> state_ = make_shared<GameState>();
+    shared_ptr<RoomDirectory> rooms_ = make_shared<RoomDirectory>();
+    string defaultText_;
     unique_ptr<httplib::Server> server_;
     thread worker_;
     atomic<bool> running_{false};
     int port_ = 0;
-};
\ No newline at end of file
+
+    socket_t channelListener_ = INVALID_SOCKET;
+    thread channelWorker_;
+    atomic<bool> channelRunning_{false};
+
+    thread reaper_;
+    mutex reaperMutex_;
+    condition_variable reaperCv_;
+    bool reaperStop_ = false;
+};
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <vector>
 #include <cstring>
+#include "profiler.h"
 
 static bool ParseAnnounce(const string& msg, HostAnnounce& out) {
     if (msg.rfind("TYPETAG|1|") != 0) return false;
@@ -35,6 +36,7 @@ bool UDPBroadcaster::start(int udpPort, function<string()> payloadFn, int interv
 
     running_ = true;
     th_ = thread([this, udpPort, payloadFn, intervalMs]() {
+        Profiler::setThreadName("udp-broadcast");
         UDPsocket sock = SDLNet_UDP_Open(0); // 绑定到任意可用端口
         if (!sock) {
             cout << "Failed to open UDP socket for broadcasting: " << SDLNet_GetError() << endl;
@@ -59,6 +61,7 @@ bool UDPBroadcaster::start(int udpPort, function<string()> payloadFn, int interv
         }
 
         while (running_) {
+            ProfileZone zone("udp.broadcast");
             string payload = payloadFn();
             if (payload.length() >= packet->maxlen) {
                 cout << "Payload too large for UDP packet" << endl;
@@ -73,6 +76,7 @@ bool UDPBroadcaster::start(int udpPort, function<string()> payloadFn, int interv
                 cout << "Failed to send UDP broadcast: " << SDLNet_GetError() << endl;
             }
 
+            zone.end();
             this_thread::sleep_for(chrono::milliseconds(intervalMs));
         }
 
@@ -95,6 +99,7 @@ bool UDPListener::start(int udpPort, function<void(const HostAnnounce&)> onHost,
 
     running_ = true;
     th_ = thread([this, udpPort, onHost, intervalMs]() {
+        Profiler::setThreadName("udp-listen");
         UDPsocket sock = SDLNet_UDP_Open(udpPort);
         if (!sock) {
             cout << "Failed to open UDP socket for listening: " << SDLNet_GetError() << endl;
@@ -111,6 +116,7 @@ bool UDPListener::start(int udpPort, function<void(const HostAnnounce&)> onHost,
         }
 
         while (running_) {
+            ProfileZone zone("udp.listen");
             int result = SDLNet_UDP_Recv(sock, packet);
             if (result > 0) {
                 string msg((char*)packet->data, packet->len);
@@ -130,6 +136,7 @@ bool UDPListener::start(int udpPort, function<void(const HostAnnounce&)> onHost,
             } else if (result == -1) {
                 cout << "UDP receive error: " << SDLNet_GetError() << endl;
             }
+            zone.end();
 
             this_thread::sleep_for(chrono::milliseconds(intervalMs));
         }
@@ -15,10 +15,10 @@ public:
     ~Player() = default;
 
     void init(SDL_Renderer* renderer, const string& idlePath, const string& walkPath) {
-        animIdle.setAtlas(renderer, idlePath, FRAME_W, FRAME_H, 0, 0, 4, 6);
+        animIdle.setAtlas(renderer, idlePath, ClipGrid<FRAME_W, FRAME_H, 0, 0, 4, 6>::DESC);
         animIdle.setInterval(0.1f);
         animIdle.setLoop(true);
-        animWalk.setAtlas(renderer, walkPath, FRAME_W, FRAME_H, 0, 0, 4, 8);
+        animWalk.setAtlas(renderer, walkPath, ClipGrid<FRAME_W, FRAME_H, 0, 0, 4, 8>::DESC);
         animWalk.setInterval(0.1f);
         animWalk.setLoop(true);
     }
@@ -50,9 +50,9 @@ public:
         curAnim->onUpdate(deltaTime);
     }
 
-    void onRender(SDL_Renderer *renderer, const Camera& camera) {
+    void onRender(SpriteBatch& batch, const Camera& camera) {
         if (!curAnim) return;
-        curAnim->onRender(renderer, camera);
+        curAnim->onRender(batch, camera);
     }
 
     void setPosition(const Vector2& pos) {
@@ -0,0 +1,335 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+atomic<bool> Profiler::active_{false};
+thread_local int ProfileZone::threadDepth_ = 0;
+thread_local Profiler::ThreadRing *Profiler::threadRing_ = nullptr;
+thread_local char Profiler::threadName_[32] = {};
+
+// 叠加层用的 3x5 点阵字体，每行 3 位、自上而下 5 行，小写字母按大写绘制
+static constexpr Uint16 glyph(int r0, int r1, int r2, int r3, int r4) {
+    return Uint16(r0 << 12 | r1 << 9 | r2 << 6 | r3 << 3 | r4);
+}
+static const Uint16 GLYPH_DIGITS[10] = {
+    glyph(7, 5, 5, 5, 7), glyph(2, 6, 2, 2, 7), glyph(7, 1, 7, 4, 7), glyph(7, 1, 7, 1, 7), glyph(5, 5, 7, 1, 1),
+    glyph(7, 4, 7, 1, 7), glyph(7, 4, 7, 5, 7), glyph(7, 1, 1, 1, 1), glyph(7, 5, 7, 5, 7), glyph(7, 5, 7, 1, 7),
+};
+static const Uint16 GLYPH_LETTERS[26] = {
+    glyph(2, 5, 7, 5, 5), glyph(6, 5, 6, 5, 6), glyph(3, 4, 4, 4, 3), glyph(6, 5, 5, 5, 6), glyph(7, 4, 6, 4, 7),
+    glyph(7, 4, 6, 4, 4), glyph(3, 4, 5, 5, 3), glyph(5, 5, 7, 5, 5), glyph(7, 2, 2, 2, 7), glyph(1, 1, 1, 5, 2),
+    glyph(5, 5, 6, 5, 5), glyph(4, 4, 4, 4, 7), glyph(5, 7, 7, 5, 5), glyph(6, 5, 5, 5, 5), glyph(2, 5, 5, 5, 2),
+    glyph(6, 5, 6, 4, 4), glyph(2, 5, 5, 6, 3), glyph(6, 5, 6, 5, 5), glyph(3, 4, 2, 1, 6), glyph(7, 2, 2, 2, 2),
+    glyph(5, 5, 5, 5, 7), glyph(5, 5, 5, 5, 2), glyph(5, 5, 7, 7, 5), glyph(5, 5, 2, 5, 5), glyph(5, 5, 2, 2, 2),
+    glyph(7, 1, 2, 4, 7),
+};
+
+static Uint16 glyphOf(char c) {
+    if (c >= '0' && c <= '9') return GLYPH_DIGITS[c - '0'];
+    if (c >= 'a' && c <= 'z') return GLYPH_LETTERS[c - 'a'];
+    if (c >= 'A' && c <= 'Z') return GLYPH_LETTERS[c - 'A'];
+    switch (c) {
+    case '.': return glyph(0, 0, 0, 0, 2);
+    case '/': return glyph(1, 1, 2, 4, 4);
+    case '-': return glyph(0, 0, 7, 0, 0);
+    case ':': return glyph(0, 2, 0, 2, 0);
+    case '_': return glyph(0, 0, 0, 0, 7);
+    case '%': return glyph(5, 1, 2, 4, 5);
+    default: return 0;
+    }
+}
+
+static const int GLYPH_SCALE = 2;
+static const int GLYPH_ADVANCE = 4 * GLYPH_SCALE;
+static const int LINE_HEIGHT = 7 * GLYPH_SCALE;
+static const int OVERLAY_X = 8, OVERLAY_Y = 8;
+static const int GRAPH_H = 60;
+static const float GRAPH_MAX_MS = 33.3f; // 曲线顶端对应的帧时间
+static const float BUDGET_MS = 1000.0f / 60;
+
+Profiler &Profiler::getInstance() {
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler() {
+    scratch_.resize(RING_SIZE);
+    originTicks_ = profileNow();
+    originCounter_ = SDL_GetPerformanceCounter();
+    tickFreq_ = (double)SDL_GetPerformanceFrequency();
+}
+
+void Profiler::calibrate() {
+#ifdef PROFILER_USE_TSC
+    const Uint64 counter = SDL_GetPerformanceCounter();
+    const Uint64 ticks = profileNow();
+    if (counter > originCounter_ && ticks > originTicks_) {
+        tickFreq_ = (ticks - originTicks_) * (double)SDL_GetPerformanceFrequency() / (counter - originCounter_);
+    }
+#endif
+}
+
+Profiler::ThreadRing *Profiler::threadRing() {
+    if (threadRing_) return threadRing_;
+    static thread_local RingOwner owner;
+    Profiler &p = getInstance();
+    lock_guard<mutex> lock(p.ringsMutex_);
+    ThreadRing *ring;
+    if (!p.freeRings_.empty()) {
+        ring = p.freeRings_.back();
+        p.freeRings_.pop_back();
+    } else {
+        p.rings_.push_back(make_unique<ThreadRing>());
+        ring = p.rings_.back().get();
+    }
+    ring->head.store(0, memory_order_relaxed);
+    ring->tail = 0;
+    ring->exited = false;
+    // 复用的环换一个 tid，trace 里不会和之前的线程混在一起
+    ring->tid = ++p.nextTid_;
+    if (threadName_[0]) {
+        snprintf(ring->name, sizeof(ring->name), "%s", threadName_);
+    } else {
+        snprintf(ring->name, sizeof(ring->name), "thread %d", ring->tid);
+    }
+    p.liveRings_.push_back(ring);
+    owner.ring = ring;
+    threadRing_ = ring;
+    return ring;
+}
+
+Profiler::RingOwner::~RingOwner() {
+    if (!ring) return;
+    Profiler &p = getInstance();
+    lock_guard<mutex> lock(p.ringsMutex_);
+    ring->exited = true;
+    threadRing_ = nullptr;
+    // 没在记录时不会有人取走剩下的区间，直接回收；否则留给 drain 取空后回收
+    if (!active() || ring->head.load(memory_order_relaxed) == ring->tail) {
+        p.retire(find(p.liveRings_.begin(), p.liveRings_.end(), ring) - p.liveRings_.begin());
+    }
+}
+
+void Profiler::retire(size_t index) {
+    ThreadRing *ring = liveRings_[index];
+    ThreadName n = {ring->tid, {}};
+    memcpy(n.name, ring->name, sizeof(n.name));
+    // 只有写 trace 时才用得到，平时不记，免得线程来来去去时无限增长
+    if (tracing_) retiredNames_.push_back(n);
+    liveRings_[index] = liveRings_.back();
+    liveRings_.pop_back();
+    freeRings_.push_back(ring);
+}
+
+void Profiler::record(const char *name, Uint64 begin, Uint64 end, int depth) {
+    ThreadRing *ring = threadRing();
+    const Uint64 head = ring->head.load(memory_order_relaxed);
+    ring->events[head & (RING_SIZE - 1)] = {name, begin, end, depth};
+    ring->head.store(head + 1, memory_order_release);
+}
+
+void Profiler::setThreadName(const char *name) {
+    // 只记下名字，不分配环：不开叠加层或 trace 时线程不应为此付出内存
+    snprintf(threadName_, sizeof(threadName_), "%s", name);
+    if (!threadRing_) return;
+    lock_guard<mutex> lock(getInstance().ringsMutex_);
+    snprintf(threadRing_->name, sizeof(threadRing_->name), "%s", name);
+}
+
+void Profiler::updateActive() {
+    active_.store(overlay_ || tracing_, memory_order_relaxed);
+}
+
+void Profiler::startTrace() {
+    {
+        // 线程退出时在别的线程上读 tracing_，改它要持有 ringsMutex_
+        lock_guard<mutex> lock(ringsMutex_);
+        tracing_ = true;
+    }
+    traceStart_ = profileNow();
+    trace_.reserve(64 * 1024);
+    updateActive();
+}
+
+void Profiler::toggleOverlay() {
+    overlay_ = !overlay_;
+    zones_.clear();
+    updateActive();
+}
+
+void Profiler::drain() {
+    lock_guard<mutex> lock(ringsMutex_);
+    for (size_t r = 0; r < liveRings_.size();) {
+        ThreadRing *ring = liveRings_[r];
+        const Uint64 head = ring->head.load(memory_order_acquire);
+        Uint64 tail = ring->tail;
+        if (head - tail > RING_SIZE) {
+            dropped_ += head - tail - RING_SIZE;
+            tail = head - RING_SIZE;
+        }
+        const int count = (int)(head - tail);
+        for (int i = 0; i < count; ++i) {
+            scratch_[i] = ring->events[(tail + i) & (RING_SIZE - 1)];
+        }
+        // 拷贝期间写入方可能又写了一圈，被覆盖过的槽位（含正在写的那一个）作废
+        const Uint64 written = ring->head.load(memory_order_acquire);
+        int first = 0;
+        if (written - tail >= RING_SIZE) {
+            first = (int)min<Uint64>(written - tail - RING_SIZE + 1, count);
+            dropped_ += first;
+        }
+        ring->tail = head;
+        for (int i = first; i < count; ++i) {
+            const ProfileEvent &e = scratch_[i];
+            if (overlay_) addToFrame(e);
+            if (tracing_ && trace_.size() < MAX_TRACE_EVENTS) trace_.push_back({e.name, e.begin, e.end, ring->tid});
+        }
+        // 线程退出后 head 不再变化，这次已经取空
+        if (ring->exited) {
+            retire(r);
+        } else {
+            ++r;
+        }
+    }
+}
+
+void Profiler::addToFrame(const ProfileEvent &e) {
+    const double ms = ticksToMs(e.end - e.begin);
+    for (auto &z : zones_) {
+        if (z.name == e.name) {
+            z.frameMs += ms;
+            return;
+        }
+    }
+    zones_.push_back({e.name, e.depth, ms, ms});
+}
+
+void Profiler::endFrame() {
+    const Uint64 now = SDL_GetPerformanceCounter();
+    if (lastFrame_ != 0) {
+        history_[historyPos_] = float((now - lastFrame_) * 1000.0 / SDL_GetPerformanceFrequency());
+        historyPos_ = (historyPos_ + 1) % HISTORY;
+    }
+    lastFrame_ = now;
+    if (!active()) return;
+    calibrate();
+    for (auto &z : zones_) z.frameMs = 0;
+    drain();
+    for (auto &z : zones_) z.avgMs = z.avgMs * 0.9 + z.frameMs * 0.1;
+}
+
+void Profiler::drawText(int x, int y, const char *text) {
+    for (; *text; ++text, x += GLYPH_ADVANCE) {
+        const Uint16 bits = glyphOf(*text);
+        for (int row = 0; row < 5; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                if (bits & (1 << ((4 - row) * 3 + (2 - col)))) {
+                    glyphRects_.push_back({x + col * GLYPH_SCALE, y + row * GLYPH_SCALE, GLYPH_SCALE, GLYPH_SCALE});
+                }
+            }
+        }
+    }
+}
+
+void Profiler::renderOverlay(SDL_Renderer *r) {
+    if (!overlay_) return;
+    Uint8 cr, cg, cb, ca;
+    SDL_BlendMode blend;
+    SDL_GetRenderDrawColor(r, &cr, &cg, &cb, &ca);
+    SDL_GetRenderDrawBlendMode(r, &blend);
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+
+    const int width = HISTORY * 2 + 16;
+    const int height = GRAPH_H + LINE_HEIGHT * (2 + (int)zones_.size()) + 16;
+    const SDL_Rect panel = {OVERLAY_X, OVERLAY_Y, width, height};
+    SDL_SetRenderDrawColor(r, 0, 0, 0, 180);
+    SDL_RenderFillRect(r, &panel);
+
+    // 帧时间曲线：最新的一帧在最右边，绿色在 60 帧预算内，黄色在 30 帧内，红色超出
+    const int graphX = OVERLAY_X + 8, graphBottom = OVERLAY_Y + 8 + GRAPH_H;
+    float sum = 0, worst = 0;
+    for (int i = 0; i < HISTORY; ++i) {
+        const float ms = history_[(historyPos_ + i) % HISTORY];
+        sum += ms;
+        worst = max(worst, ms);
+        const int h = (int)(min(ms, GRAPH_MAX_MS) / GRAPH_MAX_MS * GRAPH_H);
+        const SDL_Rect bar = {graphX + i * 2, graphBottom - h, 2, h};
+        if (ms <= BUDGET_MS) {
+            SDL_SetRenderDrawColor(r, 80, 200, 80, 255);
+        } else if (ms <= GRAPH_MAX_MS) {
+            SDL_SetRenderDrawColor(r, 220, 200, 60, 255);
+        } else {
+            SDL_SetRenderDrawColor(r, 220, 60, 60, 255);
+        }
+        SDL_RenderFillRect(r, &bar);
+    }
+    const int budgetY = graphBottom - (int)(BUDGET_MS / GRAPH_MAX_MS * GRAPH_H);
+    SDL_SetRenderDrawColor(r, 255, 255, 255, 120);
+    SDL_RenderDrawLine(r, graphX, budgetY, graphX + HISTORY * 2, budgetY);
+
+    // 文字：平均 / 最差帧时间，之后每个区间一行，按嵌套深度缩进
+    char line[64];
+    glyphRects_.clear();
+    int y = graphBottom + 6;
+    snprintf(line, sizeof(line), "frame %.2f ms  max %.2f", sum / HISTORY, worst);
+    drawText(graphX, y, line);
+    y += LINE_HEIGHT;
+    if (dropped_ > 0) {
+        snprintf(line, sizeof(line), "dropped %llu", (unsigned long long)dropped_);
+        drawText(graphX, y, line);
+    }
+    y += LINE_HEIGHT;
+    for (auto &z : zones_) {
+        snprintf(line, sizeof(line), "%*s%-14s %6.2f", z.depth * 2, "", z.name, z.avgMs);
+        drawText(graphX, y, line);
+        y += LINE_HEIGHT;
+    }
+    SDL_SetRenderDrawColor(r, 230, 230, 230, 255);
+    if (!glyphRects_.empty()) SDL_RenderFillRects(r, glyphRects_.data(), (int)glyphRects_.size());
+
+    SDL_SetRenderDrawBlendMode(r, blend);
+    SDL_SetRenderDrawColor(r, cr, cg, cb, ca);
+}
+
+bool Profiler::writeTrace(const string &path) {
+    if (!tracing_) return false;
+    drain();
+    calibrate();
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) {
+        SDL_Log("无法写入 trace 文件 %s", path.c_str());
+        return false;
+    }
+    const double toUs = ticksToMs(1000);
+    fprintf(f, "{\"traceEvents\":[");
+    {
+        lock_guard<mutex> lock(ringsMutex_);
+        const char *sep = "\n";
+        for (ThreadRing *ring : liveRings_) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", sep, ring->tid, ring->name);
+            sep = ",\n";
+        }
+        for (const ThreadName &n : retiredNames_) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", sep, n.tid, n.name);
+            sep = ",\n";
+        }
+    }
+    // 区间名都是代码里的字面量，不含需要转义的字符
+    for (const auto &e : trace_) {
+        fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", e.name, e.tid,
+                (Sint64)(e.begin - traceStart_) * toUs, (e.end - e.begin) * toUs);
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    const bool ok = fclose(f) == 0;
+    SDL_Log("trace 已写入 %s：%zu 个区间%s", path.c_str(), trace_.size(), trace_.size() >= MAX_TRACE_EVENTS ? "（已达上限，之后的被丢弃）" : "");
+    // 写出后结束这次 trace，释放记录的区间和已退出线程的名字
+    {
+        lock_guard<mutex> lock(ringsMutex_);
+        tracing_ = false;
+        vector<ThreadName>().swap(retiredNames_);
+    }
+    vector<TraceEvent>().swap(trace_);
+    updateActive();
+    return ok;
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PROFILER_USE_TSC 1
+#endif
+using namespace std;
+
+/**
+ * 区间时间戳：x86 上直接读 TSC，比 SDL_GetPerformanceCounter 走系统时钟便宜一半左右；其他平台用性能计数器
+ * 换算成时间时用 Profiler::ticksToMs
+ */
+inline Uint64 profileNow() {
+#ifdef PROFILER_USE_TSC
+    return __rdtsc();
+#else
+    return SDL_GetPerformanceCounter();
+#endif
+}
+
+/**
+ * 一个已结束的分析区间，name 必须是字符串字面量（按指针区分区间）
+ */
+struct ProfileEvent {
+    const char *name;
+    Uint64 begin, end; // profileNow 的时间戳
+    int depth;         // 所在线程上的嵌套深度
+};
+
+/**
+ * 帧分析器
+ * 每个线程把结束的区间写进自己的环形缓冲（只有写入方一个线程，不加锁），主线程在 endFrame 中统一取走：
+ * 汇总为每个区间本帧的耗时供叠加层显示，开启 trace 时再按 Chrome trace-event 格式保存
+ * 叠加层隐藏且未开启 trace 时区间只检查一次开关，几乎没有开销
+ */
+class Profiler {
+public:
+    static const int RING_SIZE = 4096;          // 每个线程缓冲的区间数，须为 2 的幂
+    static const int HISTORY = 120;             // 帧时间曲线保留的帧数
+    static const int MAX_TRACE_EVENTS = 1 << 20; // trace 最多保存的区间数，超出后丢弃
+
+    static Profiler &getInstance();
+
+    /**
+     * 是否在记录区间：叠加层显示中或正在 trace
+     */
+    static bool active() { return active_.load(memory_order_relaxed); }
+    /**
+     * 记录当前线程的一个区间，由 ProfileZone 调用
+     */
+    static void record(const char *name, Uint64 begin, Uint64 end, int depth);
+    /**
+     * 设置当前线程在叠加层和 trace 中显示的名字
+     */
+    static void setThreadName(const char *name);
+
+    /**
+     * 开始记录 trace，退出前调用 writeTrace 保存
+     */
+    void startTrace();
+    /**
+     * 按 Chrome trace-event 格式写出 trace（可在 chrome://tracing 或 Perfetto 中打开），写出后结束这次 trace
+     */
+    bool writeTrace(const string &path);
+
+    void toggleOverlay();
+    bool overlayVisible() const { return overlay_; }
+
+    /**
+     * 主线程每帧末尾调用：取走各线程记录的区间，更新帧时间和各区间耗时
+     */
+    void endFrame();
+    /**
+     * 绘制叠加层：帧时间曲线和各区间的毫秒数，叠加层隐藏时不绘制
+     */
+    void renderOverlay(SDL_Renderer *r);
+
+    /**
+     * 把 profileNow 的时间差换算成毫秒
+     */
+    double ticksToMs(Uint64 ticks) const { return ticks * 1000.0 / tickFreq_; }
+
+private:
+    struct ThreadRing {
+        char name[32] = {};
+        int tid = 0;
+        bool exited = false;    // 所属线程已退出，取空后才能复用
+        atomic<Uint64> head{0}; // 写入方已发布的区间数
+        Uint64 tail = 0;        // 主线程已取走的区间数
+        ProfileEvent events[RING_SIZE];
+    };
+    struct ZoneStat {
+        const char *name;
+        int depth;
+        double frameMs; // 本帧累计
+        double avgMs;   // 平滑后的值，供显示
+    };
+    struct TraceEvent {
+        const char *name;
+        Uint64 begin, end;
+        int tid;
+    };
+    struct ThreadName {
+        int tid;
+        char name[32];
+    };
+    /**
+     * 每个记录过区间的线程各有一个，线程退出时析构，把环还给 Profiler
+     */
+    struct RingOwner {
+        ThreadRing *ring = nullptr;
+        ~RingOwner();
+    };
+
+    Profiler();
+
+    static ThreadRing *threadRing();
+    void retire(size_t index);
+    void updateActive();
+    void calibrate();
+    void drain();
+    void addToFrame(const ProfileEvent &e);
+    void drawText(int x, int y, const char *text);
+
+    static atomic<bool> active_;
+    static thread_local ThreadRing *threadRing_;
+    static thread_local char threadName_[32]; // setThreadName 设置的名字，线程第一次记录时拷进环里
+
+    mutex ringsMutex_; // 线程取得或归还环、改名，以及主线程取走区间时加锁
+    vector<unique_ptr<ThreadRing>> rings_; // 分配过的所有环
+    vector<ThreadRing *> liveRings_;       // 线程还在、或线程已退出但还没取空的环，drain 只遍历这些
+    vector<ThreadRing *> freeRings_;       // 已取空、可给新线程复用的环
+    vector<ThreadName> retiredNames_;      // trace 期间退出的线程的名字，写 trace 时输出并清空
+    int nextTid_ = 0;
+    vector<ProfileEvent> scratch_;
+    Uint64 dropped_ = 0; // 写入方绕圈覆盖、来不及取走的区间数
+
+    // TSC 频率按启动以来 TSC 与性能计数器的增量比例估算，运行越久越准
+    Uint64 originTicks_ = 0, originCounter_ = 0;
+    double tickFreq_ = 1;
+
+    bool overlay_ = false;
+    bool tracing_ = false; // 由主线程在持有 ringsMutex_ 时修改
+    Uint64 traceStart_ = 0;
+    vector<TraceEvent> trace_;
+
+    Uint64 lastFrame_ = 0;
+    float history_[HISTORY] = {};
+    int historyPos_ = 0;
+    vector<ZoneStat> zones_;
+    vector<SDL_Rect> glyphRects_;
+};
+
+/**
+ * 作用域分析区间：构造时开始，析构时结束
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char *name) {
+        if (!Profiler::active()) return;
+        name_ = name;
+        depth_ = threadDepth_++;
+        begin_ = profileNow();
+    }
+    ~ProfileZone() { end(); }
+
+    /**
+     * 提前结束区间，之后析构时不再记录；用于不便加花括号划分作用域的长代码段
+     */
+    void end() {
+        if (!name_) return;
+        Profiler::record(name_, begin_, profileNow(), depth_);
+        threadDepth_--;
+        name_ = nullptr;
+    }
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    static thread_local int threadDepth_;
+
+    const char *name_ = nullptr;
+    Uint64 begin_ = 0;
+    int depth_ = 0;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
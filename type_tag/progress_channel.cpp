@@ -0,0 +1,46 @@
+#include "progress_channel.h"
+
+// 只当客户端时进程里没有 httplib::Server，不会忽略 SIGPIPE，向已断开的连接写入时不能让信号结束进程
+#ifdef MSG_NOSIGNAL
+static const int CHANNEL_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int CHANNEL_SEND_FLAGS = 0;
+#endif
+
+socket_t openChannelListener(const string &bindAddr, int port) {
+    socket_t sock = httplib::detail::create_socket(
+        bindAddr, string(), port, AF_UNSPEC, AI_PASSIVE, true, false, httplib::default_socket_options,
+        [](socket_t s, struct addrinfo &ai, bool &) -> bool {
+            if (::bind(s, ai.ai_addr, (socklen_t)ai.ai_addrlen)) return false;
+            return ::listen(s, SOMAXCONN) == 0;
+        });
+    if (sock != INVALID_SOCKET) {
+        httplib::detail::set_nonblocking(sock, true);
+    }
+    return sock;
+}
+
+socket_t connectChannel(const string &host, int port) {
+    return httplib::detail::create_socket(
+        host, string(), port, AF_UNSPEC, 0, true, false, nullptr,
+        [](socket_t s, struct addrinfo &ai, bool &) -> bool {
+#ifdef SO_NOSIGPIPE
+            httplib::detail::set_socket_opt(s, SOL_SOCKET, SO_NOSIGPIPE, 1);
+#endif
+            return ::connect(s, ai.ai_addr, (socklen_t)ai.ai_addrlen) == 0;
+        });
+}
+
+bool sendFrames(socket_t sock, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        const ssize_t n = httplib::detail::send_socket(sock, data, len, CHANNEL_SEND_FLAGS);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+void closeChannel(socket_t sock) {
+    if (sock != INVALID_SOCKET) httplib::detail::close_socket(sock);
+}
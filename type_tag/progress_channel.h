@@ -0,0 +1,103 @@
+#pragma once
+#include "./libs/httplib.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+/**
+ * 进度通道：登录后客户端与服务器之间的一条 TCP 长连接，代替每 100ms 一次的 HTTP /progress 轮询
+ * 双方只收发固定 8 字节的帧（小端）：[0] 类型  [1] 保留，为 0  [2..3] 玩家 id  [4..7] 数值
+ *   客户端 -> 服务器：连接后先发 HELLO（数值为协议版本）和 ROOM（数值为房间 id），之后只在自己的进度变化时发 PROGRESS
+ *   服务器 -> 客户端：每个 tick 推送同一房间内有变化的玩家进度；玩家数变化时先发 PLAYERS（数值为玩家数）；新连接先收到一次完整快照
+ * 通道端口由 /login 响应的 X-Progress-Port 头告知，没有这个头或连接失败时客户端仍用 HTTP 轮询
+ */
+static const int PROGRESS_FRAME_SIZE = 8;
+static const int PROGRESS_CHANNEL_VERSION = 2;     // 2：增加 ROOM 帧
+static const int PROGRESS_CHANNEL_PORT_OFFSET = 1; // 通道端口 = HTTP 端口 + 1
+static const int PROGRESS_CHANNEL_TICK_MS = 16;    // 服务器推送、客户端检查进度变化的间隔，约为一帧
+static const char *const PROGRESS_PORT_HEADER = "X-Progress-Port";
+
+enum class FrameType : uint8_t { Hello = 1, Progress = 2, Players = 3, Room = 4 };
+
+struct ProgressFrame {
+    FrameType type;
+    int id;
+    int value;
+};
+
+inline void encodeFrame(const ProgressFrame &f, uint8_t *out) {
+    const uint32_t v = (uint32_t)f.value;
+    out[0] = (uint8_t)f.type;
+    out[1] = 0;
+    out[2] = (uint8_t)(f.id & 0xFF);
+    out[3] = (uint8_t)((f.id >> 8) & 0xFF);
+    out[4] = (uint8_t)(v & 0xFF);
+    out[5] = (uint8_t)((v >> 8) & 0xFF);
+    out[6] = (uint8_t)((v >> 16) & 0xFF);
+    out[7] = (uint8_t)(v >> 24);
+}
+
+/**
+ * 解码一帧，类型未知或保留字节不为 0 时返回 false（对端不是进度通道或数据已错位）
+ */
+inline bool decodeFrame(const uint8_t *in, ProgressFrame &f) {
+    if (in[0] < (uint8_t)FrameType::Hello || in[0] > (uint8_t)FrameType::Room || in[1] != 0) return false;
+    f.type = (FrameType)in[0];
+    f.id = in[2] | (in[3] << 8);
+    f.value = (int)(in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24));
+    return true;
+}
+
+/**
+ * 把 TCP 字节流切成帧：recv 到的数据可能只有半帧，剩下的留到下次
+ */
+class FrameReader {
+public:
+    static const int CAPACITY = PROGRESS_FRAME_SIZE * 512;
+
+    uint8_t *space() { return buf_ + len_; }
+    int spaceSize() const { return CAPACITY - len_; }
+    void commit(int n) { len_ += n; }
+
+    /**
+     * 取出下一帧，数据不足一帧时返回 false；帧无法解码时同样返回 false 并置 bad()
+     */
+    bool next(ProgressFrame &f) {
+        if (len_ - pos_ < PROGRESS_FRAME_SIZE) {
+            // 剩下的半帧挪到开头，腾出空间
+            memmove(buf_, buf_ + pos_, len_ - pos_);
+            len_ -= pos_;
+            pos_ = 0;
+            return false;
+        }
+        if (!decodeFrame(buf_ + pos_, f)) {
+            bad_ = true;
+            return false;
+        }
+        pos_ += PROGRESS_FRAME_SIZE;
+        return true;
+    }
+    bool bad() const { return bad_; }
+
+private:
+    uint8_t buf_[CAPACITY];
+    int len_ = 0;
+    int pos_ = 0;
+    bool bad_ = false;
+};
+
+/**
+ * 在 bindAddr:port 上监听，返回非阻塞的监听套接字，失败时返回 INVALID_SOCKET
+ */
+socket_t openChannelListener(const string &bindAddr, int port);
+/**
+ * 阻塞连接到 host:port（关闭 Nagle），失败时返回 INVALID_SOCKET
+ */
+socket_t connectChannel(const string &host, int port);
+/**
+ * 发送全部数据；出错或非阻塞套接字的发送缓冲已满时返回 false，此时流中可能留下半帧，调用方应关闭连接
+ */
+bool sendFrames(socket_t sock, const uint8_t *data, size_t len);
+void closeChannel(socket_t sock);
@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+enum class RequestKind { Login, Text, Progress };
+static const int REQUEST_KIND_NUM = 3;
+
+/**
+ * 延迟直方图（微秒）：小于 16us 每微秒一个桶，之后每个 2 的幂区间均分为 8 个桶（相对误差不超过 12.5%），
+ * 最大约 2^40us，更大的计入最后一个桶；各桶是原子计数，多个线程可以同时记录
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 3;
+    static const int SUB = 1 << SUB_BITS;
+    static const int LINEAR = SUB * 2;   // 线性部分的桶数
+    static const int MAX_EXP = 40;
+    static const int BUCKETS = LINEAR + (MAX_EXP - SUB_BITS) * SUB;
+
+    void record(uint64_t us) { buckets_[bucketOf(us)].fetch_add(1, memory_order_relaxed); }
+
+    uint64_t bucketCount(int i) const { return buckets_[i].load(memory_order_relaxed); }
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (int i = 0; i < BUCKETS; ++i) n += bucketCount(i);
+        return n;
+    }
+    /**
+     * 第 p（0..1）分位所在桶的上界（微秒），没有样本时返回 0
+     */
+    uint64_t percentile(double p) const {
+        const uint64_t n = count();
+        if (n == 0) return 0;
+        const uint64_t rank = (uint64_t)(p * (n - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += bucketCount(i);
+            if (seen >= rank) return bucketHigh(i);
+        }
+        return bucketHigh(BUCKETS - 1);
+    }
+
+    static int bucketOf(uint64_t us) {
+        if (us < (uint64_t)LINEAR) return (int)us;
+        int e = SUB_BITS + 1;
+        while (e < MAX_EXP && (us >> (e + 1)) != 0) ++e;
+        if ((us >> (e + 1)) != 0) return BUCKETS - 1;
+        const int sub = (int)((us >> (e - SUB_BITS)) & (SUB - 1));
+        return LINEAR + (e - SUB_BITS - 1) * SUB + sub;
+    }
+    static uint64_t bucketLow(int i) {
+        if (i < LINEAR) return (uint64_t)i;
+        const int e = (i - LINEAR) / SUB + SUB_BITS + 1;
+        const uint64_t sub = (uint64_t)((i - LINEAR) % SUB);
+        return (1ULL << e) + (sub << (e - SUB_BITS));
+    }
+    static uint64_t bucketHigh(int i) {
+        if (i < LINEAR) return (uint64_t)i + 1;
+        const int e = (i - LINEAR) / SUB + SUB_BITS + 1;
+        return bucketLow(i) + (1ULL << (e - SUB_BITS));
+    }
+
+private:
+    atomic<uint64_t> buckets_[BUCKETS] = {};
+};
+
+/**
+ * 客户端请求统计：按请求种类计数、记错误和往返延迟，可由多个 NetworkClient 共享（压力测试用）
+ * 进度通道上没有请求/响应，发出一帧算一次请求，服务器把同一个进度推回来时记一次往返；
+ * 推回之前又发了新进度的帧会被服务器合并，只计请求不计延迟
+ */
+struct RequestStats {
+    atomic<uint64_t> requests[REQUEST_KIND_NUM] = {};
+    atomic<uint64_t> errors[REQUEST_KIND_NUM] = {};
+    LatencyHistogram rtt[REQUEST_KIND_NUM];
+
+    void sent(RequestKind kind) { requests[(int)kind].fetch_add(1, memory_order_relaxed); }
+    /**
+     * 请求完成：失败计错误，成功时记录从 start 到现在的往返时间
+     */
+    void completed(RequestKind kind, chrono::steady_clock::time_point start, bool ok) {
+        if (!ok) {
+            errors[(int)kind].fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        const auto us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        rtt[(int)kind].record((uint64_t)max<long long>(us, 0));
+    }
+};
@@ -0,0 +1,71 @@
+#include "room_directory.h"
+#include <chrono>
+
+using namespace chrono;
+
+int64_t roomClockMs() {
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+shared_ptr<GameState> RoomDirectory::create(const string &text, int maxPlayers, bool pinned) {
+    // 先占名额再建房间，并发创建时不会超过上限
+    if (count_.fetch_add(1) >= MAX_ROOMS) {
+        count_--;
+        return nullptr;
+    }
+    auto room = make_shared<GameState>();
+    room->id = nextId_++;
+    room->text = text;
+    room->maxPlayers = maxPlayers;
+    room->pinned = pinned;
+    room->markActive();
+    Shard &shard = shardOf(room->id);
+    lock_guard<mutex> lk(shard.mtx);
+    shard.rooms.emplace(room->id, room);
+    return room;
+}
+
+shared_ptr<GameState> RoomDirectory::find(int id) const {
+    const Shard &shard = shardOf(id);
+    lock_guard<mutex> lk(shard.mtx);
+    auto it = shard.rooms.find(id);
+    return it == shard.rooms.end() ? nullptr : it->second;
+}
+
+void RoomDirectory::close(GameState &room) {
+    lock_guard<mutex> lk(room.mtx_);
+    room.closing = true;
+    room.changed_.notify_all();
+}
+
+int RoomDirectory::reap(int64_t idleMs) {
+    const int64_t deadline = roomClockMs() - idleMs;
+    vector<shared_ptr<GameState>> reaped;
+    for (Shard &shard : shards_) {
+        lock_guard<mutex> lk(shard.mtx);
+        for (auto it = shard.rooms.begin(); it != shard.rooms.end();) {
+            const GameState &room = *it->second;
+            if (room.pinned || room.lastActiveMs.load(memory_order_relaxed) > deadline) {
+                ++it;
+                continue;
+            }
+            reaped.push_back(move(it->second));
+            it = shard.rooms.erase(it);
+        }
+    }
+    // 在分片锁外关闭房间，避免和正持有房间锁再查目录的线程互相等待
+    for (auto &room : reaped) close(*room);
+    count_ -= (int)reaped.size();
+    return (int)reaped.size();
+}
+
+void RoomDirectory::closeAll() {
+    vector<shared_ptr<GameState>> all;
+    for (Shard &shard : shards_) {
+        lock_guard<mutex> lk(shard.mtx);
+        for (auto &kv : shard.rooms) all.push_back(move(kv.second));
+        shard.rooms.clear();
+    }
+    for (auto &room : all) close(*room);
+    count_ -= (int)all.size();
+}
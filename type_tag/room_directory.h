@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+static const int MAX_ROOMS = 10000;            // 同时存在的房间上限
+static const int ROOM_MAX_PLAYERS = 1024;      // POST /rooms 可指定的每房间人数上限
+static const int ROOM_IDLE_MS = 60000;         // 超过这么久没有请求、也没有推送连接的房间会被回收
+static const int ROOM_REAP_INTERVAL_MS = 5000; // 回收线程的检查间隔
+
+/**
+ * 单调时钟的毫秒数，用于记录房间最后活动时间
+ */
+int64_t roomClockMs();
+
+/**
+ * 一个房间（一场比赛）的状态，由自己的 mtx_ 保护：不同房间的请求互不阻塞
+ */
+struct GameState {
+    mutex mtx_;
+    int id = 0;
+    string text;
+    int maxPlayers = 2;
+    vector<int> progresses_;
+    uint64_t version = 0;        // progresses_ 每变一次加一，/events 据此判断要不要推送
+    shared_ptr<const string> eventSnapshot; // 已格式化好的 /events 事件，所有订阅者共用
+    uint64_t eventVersion = 0;              // eventSnapshot 对应的 version
+    condition_variable changed_; // version 变化或房间关闭时通知
+    bool closing = false;        // 房间已被回收或服务器正在关闭
+    bool pinned = false;         // 默认房间，不会因空闲被回收
+    atomic<int64_t> lastActiveMs{0};
+
+    /**
+     * progresses_ 改动后调用，需持有 mtx_
+     */
+    void touch() {
+        ++version;
+        changed_.notify_all();
+    }
+    /**
+     * 记录房间仍在使用：每个请求、以及推送连接定期调用，不需要持有 mtx_
+     */
+    void markActive() { lastActiveMs.store(roomClockMs(), memory_order_relaxed); }
+};
+
+/**
+ * 房间目录：按房间 id 分成 SHARDS 个分片，每个分片一把锁，查找房间只锁一个分片且只持有到取出 shared_ptr 为止
+ * 取出的房间即使随后被回收也仍然有效（closing 被置位），持有者应检查 closing 后放手
+ */
+class RoomDirectory {
+public:
+    static const int SHARDS = 16;
+
+    /**
+     * 新建房间，房间数已达 MAX_ROOMS 时返回 nullptr
+     */
+    shared_ptr<GameState> create(const string &text, int maxPlayers, bool pinned = false);
+    shared_ptr<GameState> find(int id) const;
+    /**
+     * 回收空闲超过 idleMs 的房间（pinned 的除外），返回回收的数量
+     */
+    int reap(int64_t idleMs);
+    /**
+     * 关闭并移除所有房间，叫醒等待中的推送连接；服务器停止时调用
+     */
+    void closeAll();
+    int size() const { return count_; }
+
+    int channelPort() const { return channelPort_; }
+    void setChannelPort(int port) { channelPort_ = port; }
+
+private:
+    struct Shard {
+        mutable mutex mtx;
+        unordered_map<int, shared_ptr<GameState>> rooms;
+    };
+
+    static void close(GameState &room);
+    Shard &shardOf(int id) { return shards_[(unsigned)id % SHARDS]; }
+    const Shard &shardOf(int id) const { return shards_[(unsigned)id % SHARDS]; }
+
+    Shard shards_[SHARDS];
+    atomic<int> nextId_{0};
+    atomic<int> count_{0};
+    atomic<int> channelPort_{0}; // 进度通道端口，所有房间共用，0 表示没有通道
+};
@@ -0,0 +1,73 @@
+#include "sprite_batch.h"
+#include <cmath>
+
+void SpriteBatch::begin(SDL_Renderer *r) {
+    renderer_ = r;
+    usedBuckets_ = 0;
+}
+
+SpriteBatch::Bucket &SpriteBatch::bucketFor(SDL_Texture *tex) {
+    for (int i = 0; i < usedBuckets_; ++i) {
+        if (buckets_[i].texture == tex) return buckets_[i];
+    }
+    if (usedBuckets_ == (int)buckets_.size()) buckets_.emplace_back();
+    Bucket &b = buckets_[usedBuckets_++];
+    int w = 1, h = 1;
+    SDL_QueryTexture(tex, nullptr, nullptr, &w, &h);
+    b.texture = tex;
+    b.invW = 1.0f / (w > 0 ? w : 1);
+    b.invH = 1.0f / (h > 0 ? h : 1);
+    b.vertices.clear();
+    return b;
+}
+
+void SpriteBatch::pushQuad(Bucket &b, const SDL_Rect &src, const SDL_FPoint corners[4]) {
+    const float u0 = src.x * b.invW, v0 = src.y * b.invH;
+    const float u1 = (src.x + src.w) * b.invW, v1 = (src.y + src.h) * b.invH;
+    const SDL_Color white = {255, 255, 255, 255};
+    // 顺序：左上、右上、右下、左下
+    b.vertices.push_back({corners[0], white, {u0, v0}});
+    b.vertices.push_back({corners[1], white, {u1, v0}});
+    b.vertices.push_back({corners[2], white, {u1, v1}});
+    b.vertices.push_back({corners[3], white, {u0, v1}});
+    stats_.sprites++;
+}
+
+void SpriteBatch::draw(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst) {
+    if (!tex) return;
+    const float x0 = dst.x, y0 = dst.y, x1 = dst.x + dst.w, y1 = dst.y + dst.h;
+    const SDL_FPoint corners[4] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    pushQuad(bucketFor(tex), src, corners);
+}
+
+void SpriteBatch::drawRotated(SDL_Texture *tex, const SDL_Rect &src, const SDL_Rect &dst, double angleDeg, const SDL_Point &pivot) {
+    if (!tex) return;
+    const float rad = float(angleDeg * M_PI / 180.0);
+    const float c = cosf(rad), s = sinf(rad);
+    const float cx = dst.x + pivot.x, cy = dst.y + pivot.y;
+    // 相对 pivot 的四个角，屏幕坐标 y 向下，正角度即顺时针
+    const float lx[4] = {-float(pivot.x), float(dst.w - pivot.x), float(dst.w - pivot.x), -float(pivot.x)};
+    const float ly[4] = {-float(pivot.y), -float(pivot.y), float(dst.h - pivot.y), float(dst.h - pivot.y)};
+    SDL_FPoint corners[4];
+    for (int k = 0; k < 4; ++k) {
+        corners[k] = {cx + lx[k] * c - ly[k] * s, cy + lx[k] * s + ly[k] * c};
+    }
+    pushQuad(bucketFor(tex), src, corners);
+}
+
+void SpriteBatch::flush() {
+    for (int i = 0; i < usedBuckets_; ++i) {
+        Bucket &b = buckets_[i];
+        const int quads = (int)b.vertices.size() / 4;
+        if (quads == 0) continue;
+        // 按需扩展共享索引
+        for (int q = (int)indices_.size() / 6; q < quads; ++q) {
+            const int v = q * 4;
+            indices_.insert(indices_.end(), {v, v + 1, v + 2, v + 2, v + 3, v});
+        }
+        SDL_RenderGeometry(renderer_, b.texture, b.vertices.data(), (int)b.vertices.size(), indices_.data(), quads * 6);
+        stats_.drawCalls++;
+        b.vertices.clear();
+    }
+    usedBuckets_ = 0;
+}
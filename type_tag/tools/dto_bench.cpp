@@ -0,0 +1,208 @@
+/**
+ * DTO 编解码对比：旧的基于字符串流的文本格式（stream）、dto.h 中 to_chars / from_chars 的文本格式（text，/events 使用）与二进制格式
+ * 对 PlayerDto 和 2 / 64 / 1000 个玩家的进度列表分别计时，并统计每次操作的堆分配次数和编码后的字节数
+ *
+ * 用法（在 type_tag 目录下，只依赖 dto.h）：
+ *   clang++ tools/dto_bench.cpp -std=c++17 -O2 -o tools/dto_bench
+ *   tools/dto_bench [--iters 200000]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../dto.h"
+using namespace std;
+using namespace chrono;
+
+// 统计堆分配次数：替换全局 operator new
+static atomic<long long> g_allocs{0};
+
+// 替换的 operator new 和这里的 free 在同一个翻译单元里，GCC 11 起会把内联后的 free 误报为与 new 不匹配
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static void *countedAlloc(size_t size) noexcept {
+    g_allocs.fetch_add(1, memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+static void countedFree(void *p) noexcept {
+    if (!p) return;
+    free(p);
+}
+
+void *operator new(size_t size) {
+    if (void *p = countedAlloc(size)) return p;
+    throw bad_alloc();
+}
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete(void *p, size_t) noexcept { countedFree(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+static volatile long long g_sink = 0; // 防止结果被优化掉
+
+// 旧的文本格式实现，只留在这里作对比
+static string legacySerialize(const PlayerDto &p) {
+    ostringstream oss;
+    oss << p.id << " " << p.progress;
+    return oss.str();
+}
+
+static PlayerDto legacyDeserialize(const string &data) {
+    PlayerDto player;
+    istringstream iss(data);
+    iss >> player.id >> player.progress;
+    return player;
+}
+
+static string legacySerializeProgresses(const vector<int> &progresses) {
+    ostringstream oss;
+    oss << progresses.size() << " ";
+    for (size_t i = 0; i < progresses.size(); ++i) {
+        oss << i << " " << progresses[i];
+        if (i < progresses.size() - 1) {
+            oss << ";";
+        }
+    }
+    return oss.str();
+}
+
+static vector<int> legacyDeserializeProgresses(const string &data) {
+    vector<int> result;
+    istringstream ss(data);
+    string playerData;
+    size_t size = 0;
+    ss >> size;
+    if (size > DTO_MAX_PLAYERS) return result;
+    result.resize(size);
+    while (getline(ss, playerData, ';')) {
+        stringstream playerSs(playerData);
+        int id = -1, process = 0;
+        playerSs >> id >> process;
+        if (id < 0 || (size_t)id >= size) {
+            continue;
+        }
+        result[id] = process;
+    }
+    return result;
+}
+
+struct Measure {
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+template <typename F>
+static Measure measure(long long iters, F &&op) {
+    for (long long i = 0; i < iters / 10 + 1; ++i) op(i); // 预热，让复用的缓冲先长到需要的大小
+    const long long allocs0 = g_allocs.load();
+    const auto t0 = steady_clock::now();
+    for (long long i = 0; i < iters; ++i) op(i);
+    const double ns = duration<double, nano>(steady_clock::now() - t0).count();
+    return {ns / iters, (double)(g_allocs.load() - allocs0) / iters};
+}
+
+static void printRow(const char *what, const char *format, size_t bytes, const Measure &m) {
+    printf("%-22s %-7s %9zu %12.1f %12.2f\n", what, format, bytes, m.nsPerOp, m.allocsPerOp);
+}
+
+static void benchPlayer(long long iters) {
+    PlayerDto p{1, 123456};
+    const string text = legacySerialize(p);
+    uint8_t bin[PLAYER_DTO_SIZE];
+    p.encode(bin, sizeof(bin));
+    const string_view binView((const char *)bin, sizeof(bin));
+
+    printRow("player encode", "stream", text.size(), measure(iters, [&](long long i) {
+        p.progress = (int)i;
+        g_sink += legacySerialize(p).size();
+    }));
+    printRow("player encode", "binary", sizeof(bin), measure(iters, [&](long long i) {
+        p.progress = (int)i;
+        uint8_t out[PLAYER_DTO_SIZE];
+        g_sink += p.encode(out, sizeof(out)) + out[6];
+    }));
+    printRow("player decode", "stream", text.size(), measure(iters, [&](long long) {
+        g_sink += legacyDeserialize(text).progress;
+    }));
+    printRow("player decode", "binary", sizeof(bin), measure(iters, [&](long long) {
+        PlayerDto out;
+        if (PlayerDto::decode(binView, out)) g_sink += out.progress;
+    }));
+}
+
+static bool benchProgresses(int players, long long iters) {
+    vector<int> progresses(players);
+    for (int i = 0; i < players; ++i) progresses[i] = (i * 7919) % 5000; // 几位数不等的进度
+    const string text = legacySerializeProgresses(progresses);
+    string buf(maxProgressesTextSize(players), '\0');
+    const string_view textView(buf.data(), formatProgresses(progresses.data(), players, &buf[0], buf.size()));
+    vector<uint8_t> bin(encodedProgressesSize(players));
+    encodeProgresses(progresses.data(), players, bin.data(), bin.size());
+    const string_view binView((const char *)bin.data(), bin.size());
+
+    // 三种格式的编码应一致（stream 与 text 是同一种文本），解码回来都应与原数据一致
+    vector<int> decoded, parsed;
+    const bool ok = textView == text && legacyDeserializeProgresses(text) == progresses && parseProgresses(textView, parsed) &&
+                    parsed == progresses && decodeProgresses(binView, decoded) && decoded == progresses;
+
+    char what[32];
+    snprintf(what, sizeof(what), "progresses x%d enc", players);
+    printRow(what, "stream", text.size(), measure(iters, [&](long long i) {
+        progresses[0] = (int)i;
+        g_sink += legacySerializeProgresses(progresses).size();
+    }));
+    printRow(what, "text", textView.size(), measure(iters, [&](long long i) {
+        progresses[0] = (int)i;
+        g_sink += formatProgresses(progresses.data(), progresses.size(), &buf[0], buf.size());
+    }));
+    printRow(what, "binary", bin.size(), measure(iters, [&](long long i) {
+        progresses[0] = (int)i;
+        g_sink += encodeProgresses(progresses.data(), progresses.size(), bin.data(), bin.size());
+    }));
+    snprintf(what, sizeof(what), "progresses x%d dec", players);
+    printRow(what, "stream", text.size(), measure(iters, [&](long long) {
+        g_sink += legacyDeserializeProgresses(text).size();
+    }));
+    printRow(what, "text", textView.size(), measure(iters, [&](long long) {
+        if (parseProgresses(textView, parsed)) g_sink += parsed.back();
+    }));
+    printRow(what, "binary", bin.size(), measure(iters, [&](long long) {
+        if (decodeProgresses(binView, decoded)) g_sink += decoded.back();
+    }));
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    long long iters = 200000;
+    for (int i = 1; i < argc; i += 2) {
+        const string opt = argv[i];
+        if (opt == "--iters" && i + 1 < argc) {
+            iters = atoll(argv[i + 1]);
+        } else {
+            printf("用法: dto_bench [--iters 200000]\n");
+            return 1;
+        }
+    }
+    if (iters <= 0) iters = 1;
+    printf("%-22s %-7s %9s %12s %12s\n", "case", "format", "bytes", "ns/op", "allocs/op");
+    benchPlayer(iters);
+    bool ok = true;
+    const int counts[] = {2, 64, 1000};
+    for (int players : counts) {
+        // 大列表每次操作耗时更长，按玩家数减少迭代次数，让每项用时相近
+        ok = benchProgresses(players, max(1LL, iters * 2 / players / 4 + 1)) && ok;
+    }
+    if (!ok) {
+        printf("round-trip mismatch\n");
+        return 1;
+    }
+    return 0;
+}
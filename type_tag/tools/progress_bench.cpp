@@ -0,0 +1,225 @@
+/**
+ * 进度同步对比：本机起一个 NetworkServer 和 N 个 NetworkClient，比较 HTTP 轮询、/events 推送与进度通道
+ * 玩家 0 只观察：模拟 60 帧渲染循环，每帧取一次 getLatestProgress；其余玩家按给定速度打字
+ * 输出回环网卡上的字节数（含 TCP/IP 头，只在 Linux 上统计）以及从 submitProgress 到观察者某一帧看到该进度的延迟
+ *
+ * 用法（在 type_tag 目录下）：
+ *   clang++ tools/progress_bench.cpp network_client.cpp network_server.cpp room_directory.cpp progress_channel.cpp profiler.cpp \
+ *       -std=c++17 -O2 -DCPPHTTPLIB_THREAD_POOL_COUNT=2100 -o tools/progress_bench $(pkg-config --cflags --libs sdl2)
+ *   tools/progress_bench [--players 4,64,1000] [--seconds 5] [--cps 5] [--mode all|http|sse|channel] [--port 28000]
+ * HTTP 轮询时每个保持连接的客户端一直占着服务器线程池里的一个线程（订阅 /events 时再多占一个），默认线程池只有 8 个，
+ * 超过 8 个玩家后新的登录要等别人的连接超时才能被处理，因此对比时用 CPPHTTPLIB_THREAD_POOL_COUNT 把线程池调大
+ * 1000 个玩家时每个客户端各有一个后台线程（订阅 /events 时再加一个上报线程），注意 ulimit -n 需大于 3200
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../network_client.h"
+#include "../network_server.h"
+using namespace std;
+using namespace chrono;
+
+static const int RING = 64;          // 每个玩家记录最近 RING 次输入的时间
+static const int FRAME_MS = 16;      // 观察者的渲染间隔
+static const int POLL_MS = 100;      // HTTP 轮询间隔，与游戏中一致
+
+enum class SyncMode { Http, Sse, Channel };
+static const char *MODE_NAMES[] = {"http", "sse", "channel"};
+
+struct RunResult {
+    int players = 0;
+    SyncMode mode = SyncMode::Http;
+    int connected = 0;
+    double seconds = 0;
+    long long updates = 0;
+    long long bytes = -1;
+    vector<double> latencyMs;
+};
+
+/**
+ * 回环网卡累计收到的字节数，不是 Linux 时返回 -1
+ */
+static long long loopbackBytes() {
+    ifstream in("/proc/net/dev");
+    string line;
+    while (getline(in, line)) {
+        const size_t colon = line.find(':');
+        if (colon == string::npos) continue;
+        string name = line.substr(0, colon);
+        name.erase(0, name.find_first_not_of(' '));
+        if (name != "lo") continue;
+        return atoll(line.c_str() + colon + 1);
+    }
+    return -1;
+}
+
+static int64_t nowNs() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static RunResult runOnce(int players, SyncMode mode, double seconds, double cps, int port) {
+    RunResult r;
+    r.players = players;
+    r.mode = mode;
+    NetworkServer server;
+    if (!server.start("127.0.0.1", port, "bench", players)) return r;
+    vector<unique_ptr<NetworkClient>> clients;
+    for (int i = 0; i < players; ++i) {
+        auto c = make_unique<NetworkClient>();
+        int id = -1;
+        if (!c->connectAndLogin("127.0.0.1", port, id) || id != i) break;
+        c->setChannelEnabled(mode == SyncMode::Channel);
+        c->setEventsEnabled(mode == SyncMode::Sse);
+        c->startProgressLoop(milliseconds(POLL_MS));
+        clients.push_back(move(c));
+    }
+    r.connected = (int)clients.size();
+    if (r.connected < 2) {
+        for (auto &c : clients) c->stop();
+        server.stop();
+        return r;
+    }
+    // 等所有连接建好、第一批快照到达后再开始计时
+    this_thread::sleep_for(milliseconds(500));
+
+    const int n = r.connected;
+    vector<atomic<int64_t>> sentAt(n * RING);
+    vector<int> seen(n, 0);
+    atomic<bool> typing{true};
+    atomic<long long> updates{0};
+    // 打字线程：每个玩家的按键间隔在平均值上下随机抖动
+    thread typist([&]() {
+        mt19937 rng(42);
+        uniform_real_distribution<double> jitter(0.5, 1.5);
+        vector<int> progress(n, 0);
+        vector<int64_t> next(n);
+        const double intervalNs = 1e9 / cps;
+        const int64_t start = nowNs();
+        for (int i = 1; i < n; ++i) next[i] = start + (int64_t)(intervalNs * jitter(rng));
+        while (typing) {
+            const int64_t now = nowNs();
+            int64_t wake = now + 5000000;
+            for (int i = 1; i < n; ++i) {
+                if (next[i] <= now) {
+                    ++progress[i];
+                    sentAt[i * RING + progress[i] % RING].store(nowNs(), memory_order_relaxed);
+                    clients[i]->submitProgress(progress[i]);
+                    updates++;
+                    next[i] = now + (int64_t)(intervalNs * jitter(rng));
+                }
+                wake = min(wake, next[i]);
+            }
+            this_thread::sleep_for(nanoseconds(max<int64_t>(wake - nowNs(), 0)));
+        }
+    });
+    // 观察者：每帧取一次最新进度，新出现的进度按它的输入时间计算延迟
+    const long long bytes0 = loopbackBytes();
+    const auto t0 = steady_clock::now();
+    while (steady_clock::now() - t0 < duration<double>(seconds)) {
+        const vector<int> latest = clients[0]->getLatestProgress();
+        const int64_t now = nowNs();
+        for (int i = 1; i < n && i < (int)latest.size(); ++i) {
+            if (latest[i] <= seen[i]) continue;
+            if (latest[i] - seen[i] < RING) {
+                r.latencyMs.push_back((now - sentAt[i * RING + latest[i] % RING].load(memory_order_relaxed)) / 1e6);
+            }
+            seen[i] = latest[i];
+        }
+        this_thread::sleep_for(milliseconds(FRAME_MS));
+    }
+    const long long bytes1 = loopbackBytes();
+    r.seconds = duration<double>(steady_clock::now() - t0).count();
+    typing = false;
+    typist.join();
+    r.updates = updates;
+    if (bytes0 >= 0 && bytes1 >= 0) r.bytes = bytes1 - bytes0;
+    // 只统计真正用上推送的客户端，连接失败的会退回 HTTP 轮询
+    if (mode == SyncMode::Channel) {
+        r.connected = (int)count_if(clients.begin(), clients.end(), [](const unique_ptr<NetworkClient> &c) { return c->usingChannel(); });
+    } else if (mode == SyncMode::Sse) {
+        r.connected = (int)count_if(clients.begin(), clients.end(), [](const unique_ptr<NetworkClient> &c) { return c->usingEvents(); });
+    }
+    for (auto &c : clients) c->stop();
+    server.stop();
+    return r;
+}
+
+static double percentile(vector<double> &v, double p) {
+    if (v.empty()) return 0;
+    const size_t k = min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static void usage() {
+    printf("用法: progress_bench [--players 4,64,1000] [--seconds 5] [--cps 5] [--mode all|http|sse|channel] [--port 28000]\n");
+}
+
+int main(int argc, char *argv[]) {
+    vector<int> counts = {4, 64, 1000};
+    double seconds = 5, cps = 5;
+    int port = 28000;
+    string mode = "all";
+    for (int i = 1; i < argc; i += 2) {
+        const string opt = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (opt == "--players") {
+            counts.clear();
+            stringstream ss(argv[i + 1]);
+            string item;
+            while (getline(ss, item, ',')) counts.push_back(atoi(item.c_str()));
+        } else if (opt == "--seconds") {
+            seconds = atof(argv[i + 1]);
+        } else if (opt == "--cps") {
+            cps = atof(argv[i + 1]);
+        } else if (opt == "--mode") {
+            mode = argv[i + 1];
+        } else if (opt == "--port") {
+            port = atoi(argv[i + 1]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (counts.empty() || seconds <= 0 || cps <= 0 || (mode != "all" && mode != "http" && mode != "sse" && mode != "channel")) {
+        usage();
+        return 1;
+    }
+    printf("progress sync: observer renders every %d ms, typists at %.1f chars/s, %.1f s per run\n", FRAME_MS, cps, seconds);
+    printf("%8s %-8s %9s %10s %12s %9s %9s %9s %9s\n", "players", "mode", "clients", "updates/s", "KB/s (lo)", "p50 ms", "p95 ms", "p99 ms", "samples");
+    fflush(stdout);
+    for (int players : counts) {
+        for (int m = 0; m < 3; ++m) {
+            if (mode != "all" && mode != MODE_NAMES[m]) continue;
+            RunResult r = runOnce(players, (SyncMode)m, seconds, cps, port);
+            port += 2; // 每次换一对端口，避开上一轮 TIME_WAIT 的连接
+            if (r.seconds <= 0) {
+                printf("%8d %-8s %9d  failed to start\n", players, MODE_NAMES[m], r.connected);
+                fflush(stdout);
+                continue;
+            }
+            char kbs[32] = "n/a";
+            if (r.bytes >= 0) snprintf(kbs, sizeof(kbs), "%.1f", r.bytes / 1024.0 / r.seconds);
+            const size_t samples = r.latencyMs.size();
+            const double p50 = percentile(r.latencyMs, 0.50), p95 = percentile(r.latencyMs, 0.95), p99 = percentile(r.latencyMs, 0.99);
+            printf("%8d %-8s %9d %10.0f %12s %9.1f %9.1f %9.1f %9zu\n", players, MODE_NAMES[m], r.connected,
+                   r.updates / r.seconds, kbs, p50, p95, p99, samples);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * 多房间压力测试：本机起一个 NetworkServer，建 N 个房间、每个房间登录若干玩家，
+ * 再用 1..T 个客户端线程不停地轮流替各房间的玩家 POST /progress（闭环，每个线程一条保持的连接），
+ * 输出每种线程数下的吞吐（请求/秒）、延迟分位数和错误数；--reap 时最后等待空闲房间被回收
+ *
+ * 用法（在 type_tag 目录下）：
+ *   clang++ tools/room_bench.cpp network_server.cpp room_directory.cpp progress_channel.cpp profiler.cpp \
+ *       -std=c++17 -O2 -o tools/room_bench $(pkg-config --cflags --libs sdl2)
+ *   tools/room_bench [--rooms 1000] [--players 2] [--threads 1,2,4,8] [--seconds 5] [--port 29000] [--reap]
+ * 每个客户端线程的保持连接占住服务器线程池里的一个线程，线程数超过池大小（默认为 max(8, 核数 - 1)）时需要用
+ * -DCPPHTTPLIB_THREAD_POOL_COUNT 调大
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../network_server.h"
+using namespace std;
+using namespace chrono;
+
+struct Player {
+    int room;
+    int id;
+    int progress = 0;
+};
+
+struct LoadResult {
+    double seconds = 0;
+    long long requests = 0;
+    long long errors = 0;
+    vector<double> latencyUs;
+};
+
+static double percentile(vector<double> &v, double p) {
+    if (v.empty()) return 0;
+    const size_t k = min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+/**
+ * 建房间并登录玩家，返回所有玩家；任何一步失败时返回空
+ */
+static vector<Player> setupRooms(int port, int rooms, int players) {
+    vector<Player> all;
+    httplib::Client cli("127.0.0.1", port);
+    cli.set_keep_alive(true);
+    for (int r = 0; r < rooms; ++r) {
+        auto res = cli.Post("/rooms?players=" + to_string(players), "", "text/plain");
+        if (!res || res->status != 200) {
+            printf("create room %d failed\n", r);
+            return {};
+        }
+        const int room = atoi(res->body.c_str());
+        const httplib::Headers headers = {{ROOM_HEADER, to_string(room)}};
+        for (int p = 0; p < players; ++p) {
+            auto login = cli.Post("/login", headers, "", "text/plain");
+            if (!login || login->status != 200 || atoi(login->body.c_str()) != p) {
+                printf("login to room %d failed\n", room);
+                return {};
+            }
+            all.push_back({room, p});
+        }
+    }
+    cli.stop(); // 释放服务器上等这条连接的线程
+    return all;
+}
+
+/**
+ * threads 个线程各自负责 players 中的一段，轮流为其中每个玩家上报进度，持续 seconds 秒
+ */
+static LoadResult runLoad(int port, vector<Player> &players, int threads, double seconds) {
+    LoadResult r;
+    vector<LoadResult> perThread(threads);
+    atomic<bool> go{false}, done{false};
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            LoadResult &out = perThread[t];
+            httplib::Client cli("127.0.0.1", port);
+            cli.set_keep_alive(true);
+            cli.set_tcp_nodelay(true);
+            const size_t begin = players.size() * t / threads, end = players.size() * (t + 1) / threads;
+            vector<int> decoded;
+            while (!go) this_thread::yield();
+            for (size_t i = begin; !done; i = i + 1 < end ? i + 1 : begin) {
+                Player &p = players[i];
+                PlayerDto dto{p.id, ++p.progress};
+                uint8_t body[PLAYER_DTO_SIZE];
+                dto.encode(body, sizeof(body));
+                const auto t0 = steady_clock::now();
+                auto res = cli.Post("/progress", {{ROOM_HEADER, to_string(p.room)}}, (const char *)body, sizeof(body), DTO_CONTENT_TYPE);
+                const double us = duration<double, micro>(steady_clock::now() - t0).count();
+                out.requests++;
+                // 响应应是本房间的进度列表，且包含刚上报的进度
+                if (!res || res->status != 200 || !decodeProgresses(res->body, decoded) || p.id >= (int)decoded.size() ||
+                    decoded[p.id] != p.progress) {
+                    out.errors++;
+                    continue;
+                }
+                out.latencyUs.push_back(us);
+            }
+            cli.stop();
+        });
+    }
+    const auto t0 = steady_clock::now();
+    go = true;
+    this_thread::sleep_for(duration<double>(seconds));
+    done = true;
+    for (auto &w : workers) w.join();
+    r.seconds = duration<double>(steady_clock::now() - t0).count();
+    for (auto &t : perThread) {
+        r.requests += t.requests;
+        r.errors += t.errors;
+        r.latencyUs.insert(r.latencyUs.end(), t.latencyUs.begin(), t.latencyUs.end());
+    }
+    return r;
+}
+
+static void usage() {
+    printf("用法: room_bench [--rooms 1000] [--players 2] [--threads 1,2,4,8] [--seconds 5] [--port 29000] [--reap]\n");
+}
+
+int main(int argc, char *argv[]) {
+    int rooms = 1000, players = 2, port = 29000;
+    double seconds = 5;
+    bool reap = false;
+    vector<int> threadCounts = {1, 2, 4, 8};
+    for (int i = 1; i < argc; ++i) {
+        const string opt = argv[i];
+        if (opt == "--reap") {
+            reap = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (opt == "--rooms") {
+            rooms = atoi(value);
+        } else if (opt == "--players") {
+            players = atoi(value);
+        } else if (opt == "--seconds") {
+            seconds = atof(value);
+        } else if (opt == "--port") {
+            port = atoi(value);
+        } else if (opt == "--threads") {
+            threadCounts.clear();
+            stringstream ss(value);
+            string item;
+            while (getline(ss, item, ',')) threadCounts.push_back(atoi(item.c_str()));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (rooms < 1 || rooms >= MAX_ROOMS || players < 1 || players > ROOM_MAX_PLAYERS || seconds <= 0 || threadCounts.empty()) {
+        usage();
+        return 1;
+    }
+
+    NetworkServer server;
+    if (!server.start("127.0.0.1", port, "room bench text", players)) return 1;
+    const auto setupStart = steady_clock::now();
+    vector<Player> all = setupRooms(port, rooms, players);
+    if (all.empty()) {
+        server.stop();
+        return 1;
+    }
+    printf("%d rooms x %d players set up in %.2f s (%d rooms on server incl. default), %u hardware threads\n", rooms, players,
+           duration<double>(steady_clock::now() - setupStart).count(), server.roomCount(), thread::hardware_concurrency());
+    printf("%8s %10s %9s %9s %9s %9s %8s\n", "threads", "req/s", "p50 us", "p95 us", "p99 us", "requests", "errors");
+    fflush(stdout);
+    for (int threads : threadCounts) {
+        if (threads < 1) continue;
+        LoadResult r = runLoad(port, all, threads, seconds);
+        printf("%8d %10.0f %9.0f %9.0f %9.0f %9lld %8lld\n", threads, r.requests / r.seconds, percentile(r.latencyUs, 0.50),
+               percentile(r.latencyUs, 0.95), percentile(r.latencyUs, 0.99), r.requests, r.errors);
+        fflush(stdout);
+    }
+    if (reap) {
+        // 所有房间都不再有请求：等过空闲时间加一次检查间隔，只应剩下默认房间
+        printf("waiting %d s for idle rooms to be reaped...\n", (ROOM_IDLE_MS + ROOM_REAP_INTERVAL_MS) / 1000 + 1);
+        fflush(stdout);
+        this_thread::sleep_for(milliseconds(ROOM_IDLE_MS + ROOM_REAP_INTERVAL_MS + 1000));
+        printf("rooms left: %d\n", server.roomCount());
+    }
+    server.stop();
+    return 0;
+}
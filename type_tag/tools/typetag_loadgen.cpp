@@ -0,0 +1,234 @@
+/**
+ * typetag_loadgen：无窗口的机器人压力测试。N 个机器人各用一个 NetworkClient 登录、取文本，
+ * 再按给定的打字速度（WPM，每词按 5 个字符计）和随机抖动逐字上报进度，结束后输出各类请求的
+ * 请求数、每秒请求数、错误数、往返延迟分位数和进度往返延迟直方图
+ * 只连接本机：默认在进程内起一个 NetworkServer，--connect 时连本机已在运行的服务器（需支持 POST /rooms）
+ *
+ * 用法（在 type_tag 目录下）：
+ *   clang++ tools/typetag_loadgen.cpp network_client.cpp network_server.cpp room_directory.cpp progress_channel.cpp profiler.cpp \
+ *       -std=c++17 -O2 -DCPPHTTPLIB_THREAD_POOL_COUNT=2100 -o tools/typetag_loadgen $(pkg-config --cflags --libs sdl2)
+ *   tools/typetag_loadgen [--bots 100] [--room-size 2] [--wpm 60] [--jitter 0.3] [--seconds 10]
+ *                         [--transport channel|sse|http] [--port 29700] [--connect]
+ * 每个走 HTTP 的机器人会占住服务器线程池里的一个线程（sse 时两个），线程池默认只有 max(8, 核数 - 1) 个，
+ * 所以进程内的服务器用 CPPHTTPLIB_THREAD_POOL_COUNT 调大；--connect 到默认编译的服务器时机器人不宜超过这个数
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../network_client.h"
+#include "../network_server.h"
+using namespace std;
+using namespace chrono;
+
+static const char *KIND_NAMES[REQUEST_KIND_NUM] = {"login", "text", "progress"};
+static const int CHARS_PER_WORD = 5;
+
+struct Bot {
+    unique_ptr<NetworkClient> client;
+    int textLen = 0;
+    int progress = 0;
+    int64_t nextKeyNs = 0;
+};
+
+static int64_t nowNs() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 进程内服务器使用的比赛文本：足够长，机器人在测试时间内打不完
+ */
+static string makeText(int chars) {
+    static const char *WORDS[] = {"type", "tag", "race", "quick", "brown", "fox", "jumps", "over", "lazy", "dog"};
+    string text;
+    for (int i = 0; (int)text.size() < chars; ++i) {
+        if (!text.empty()) text += ' ';
+        text += WORDS[(i * 7) % 10];
+    }
+    return text;
+}
+
+static void printStats(const RequestStats &stats, double seconds) {
+    printf("%-9s %10s %9s %8s %9s %9s %9s\n", "kind", "requests", "req/s", "errors", "p50 ms", "p95 ms", "p99 ms");
+    for (int k = 0; k < REQUEST_KIND_NUM; ++k) {
+        const LatencyHistogram &h = stats.rtt[k];
+        const uint64_t requests = stats.requests[k];
+        if (requests == 0) continue;
+        printf("%-9s %10llu %9.0f %8llu %9.2f %9.2f %9.2f\n", KIND_NAMES[k], (unsigned long long)requests, requests / seconds,
+               (unsigned long long)stats.errors[k].load(), h.percentile(0.50) / 1000.0, h.percentile(0.95) / 1000.0,
+               h.percentile(0.99) / 1000.0);
+    }
+}
+
+/**
+ * 按 2 的幂合并桶后画出直方图，只输出有样本的区间
+ */
+static void printHistogram(const LatencyHistogram &h) {
+    const uint64_t total = h.count();
+    if (total == 0) return;
+    vector<pair<uint64_t, uint64_t>> rows; // (区间下界 us, 样本数)
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        const uint64_t n = h.bucketCount(i);
+        if (n == 0) continue;
+        uint64_t low = 1;
+        while (low * 2 <= LatencyHistogram::bucketLow(i)) low *= 2;
+        if (LatencyHistogram::bucketLow(i) == 0) low = 0;
+        if (rows.empty() || rows.back().first != low) rows.push_back({low, 0});
+        rows.back().second += n;
+    }
+    uint64_t peak = 0;
+    for (auto &row : rows) peak = max(peak, row.second);
+    printf("progress round trip:\n");
+    for (auto &row : rows) {
+        const uint64_t high = row.first ? row.first * 2 : 1;
+        const int bar = (int)(row.second * 40 / peak);
+        printf("  %9.3f - %9.3f ms |%-40s %7.2f%% %llu\n", row.first / 1000.0, high / 1000.0, string(bar, '#').c_str(),
+               row.second * 100.0 / total, (unsigned long long)row.second);
+    }
+}
+
+static void usage() {
+    printf("用法: typetag_loadgen [--bots 100] [--room-size 2] [--wpm 60] [--jitter 0.3] [--seconds 10]\n"
+           "                      [--transport channel|sse|http] [--port 29700] [--connect]\n");
+}
+
+int main(int argc, char *argv[]) {
+    int bots = 100, roomSize = 2, port = 29700;
+    double wpm = 60, jitter = 0.3, seconds = 10;
+    string transport = "channel";
+    bool connect = false;
+    for (int i = 1; i < argc; ++i) {
+        const string opt = argv[i];
+        if (opt == "--connect") {
+            connect = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (opt == "--bots") {
+            bots = atoi(value);
+        } else if (opt == "--room-size") {
+            roomSize = atoi(value);
+        } else if (opt == "--wpm") {
+            wpm = atof(value);
+        } else if (opt == "--jitter") {
+            jitter = atof(value);
+        } else if (opt == "--seconds") {
+            seconds = atof(value);
+        } else if (opt == "--transport") {
+            transport = value;
+        } else if (opt == "--port") {
+            port = atoi(value);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (bots < 1 || roomSize < 1 || roomSize > ROOM_MAX_PLAYERS || wpm <= 0 || jitter < 0 || jitter >= 1 || seconds <= 0 ||
+        (transport != "channel" && transport != "sse" && transport != "http")) {
+        usage();
+        return 1;
+    }
+    const string host = "127.0.0.1";
+    const int rooms = (bots + roomSize - 1) / roomSize;
+    const double charsPerSec = wpm * CHARS_PER_WORD / 60;
+    // 文本长度留出余量，最快的机器人（抖动下限）也打不完
+    const int textChars = (int)(charsPerSec / (1 - jitter) * seconds * 1.2) + 64;
+
+    NetworkServer server;
+    if (!connect && !server.start(host, port, makeText(textChars), roomSize)) return 1;
+    printf("typetag_loadgen: %d bots in %d rooms of %d, %.0f wpm +-%.0f%%, transport %s, %.1f s against %s:%d%s\n", bots, rooms,
+           roomSize, wpm, jitter * 100, transport.c_str(), seconds, host.c_str(), port, connect ? "" : " (in-process server)");
+    fflush(stdout);
+
+    // 建房、登录、取文本
+    RequestStats setupStats;
+    const auto setupStart = steady_clock::now();
+    vector<int> roomIds;
+    for (int r = 0; r < rooms; ++r) {
+        int room;
+        if (!NetworkClient::createRoom(host, port, connect ? "" : makeText(textChars), roomSize, room)) break;
+        roomIds.push_back(room);
+    }
+    vector<Bot> all;
+    int failed = 0;
+    for (int i = 0; i < bots && i / roomSize < (int)roomIds.size(); ++i) {
+        Bot bot;
+        bot.client = make_unique<NetworkClient>();
+        bot.client->setStats(&setupStats);
+        bot.client->setChannelEnabled(transport == "channel");
+        bot.client->setEventsEnabled(transport == "sse");
+        int id;
+        string text;
+        if (!bot.client->connectAndLogin(host, port, id, roomIds[i / roomSize]) || !bot.client->fetchText(text) || text.empty()) {
+            failed++;
+            continue;
+        }
+        bot.textLen = (int)text.size();
+        all.push_back(move(bot));
+    }
+    const double setupSeconds = duration<double>(steady_clock::now() - setupStart).count();
+    printf("setup: %d rooms, %zu bots ready, %d failed, %.2f s\n", (int)roomIds.size(), all.size(), failed, setupSeconds);
+    printStats(setupStats, setupSeconds);
+    if (all.empty()) {
+        server.stop();
+        return 1;
+    }
+
+    // 进度阶段的统计单独记，不混入登录和取文本
+    RequestStats runStats;
+    for (auto &bot : all) {
+        bot.client->setStats(&runStats);
+        bot.client->startProgressLoop();
+    }
+    mt19937 rng(42);
+    uniform_real_distribution<double> spread(1 - jitter, 1 + jitter);
+    const double intervalNs = 1e9 / charsPerSec;
+    const int64_t start = nowNs();
+    for (auto &bot : all) bot.nextKeyNs = start + (int64_t)(intervalNs * spread(rng));
+    const int64_t end = start + (int64_t)(seconds * 1e9);
+    long long keys = 0;
+    int finished = 0;
+    // 一个线程驱动所有机器人：到点的机器人前进一个字符，然后睡到最早的下一次按键
+    for (int64_t now = nowNs(); now < end; now = nowNs()) {
+        int64_t wake = min(end, now + 5000000);
+        for (auto &bot : all) {
+            if (bot.progress >= bot.textLen) continue;
+            if (bot.nextKeyNs <= now) {
+                bot.client->submitProgress(++bot.progress);
+                keys++;
+                if (bot.progress == bot.textLen) finished++;
+                bot.nextKeyNs = now + (int64_t)(intervalNs * spread(rng));
+            }
+            wake = min(wake, bot.nextKeyNs);
+        }
+        this_thread::sleep_for(nanoseconds(max<int64_t>(wake - nowNs(), 0)));
+    }
+    const double runSeconds = (nowNs() - start) / 1e9;
+    int pushed = 0;
+    for (auto &bot : all) {
+        if (bot.client->usingChannel() || bot.client->usingEvents()) pushed++;
+    }
+    for (auto &bot : all) bot.client->stop();
+    server.stop();
+
+    printf("run: %lld keystrokes (%.0f/s), %d bots finished the text", keys, keys / runSeconds, finished);
+    if (transport == "http") {
+        printf(", polling every 100 ms\n");
+    } else {
+        // 推送连接失败的机器人会退回轮询
+        printf(", %d/%zu still on %s push\n", pushed, all.size(), transport.c_str());
+    }
+    printStats(runStats, runSeconds);
+    printHistogram(runStats.rtt[(int)RequestKind::Progress]);
+    return 0;
+}